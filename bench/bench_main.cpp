@@ -0,0 +1,542 @@
+/**
+ * @file bench_main.cpp
+ * @brief Microbenchmarks for the control hot path. Replaces main.cpp in the
+ * bench_due / bench_native environments: setup() runs every benchmark once
+ * and prints the results, loop() does nothing.
+ *
+ * Output is one CSV line per benchmark, prefixed with BENCH so it can be
+ * grepped out of the serial log:
+ *   BENCH,name,unit,samples,min,median,p99,max
+ * unit is "cycles" on the Due (DWT cycle counter, 84 MHz) and "ns" on the
+ * host. The cost of reading the counter itself is subtracted.
+ *
+ * Before timing, the fixed-point torque path is checked against the
+ * floating-point reference it replaced:
+ *   ACCURACY,name,cases,max_err_lsb,mismatches
+ * max_err_lsb is the largest difference in output LSBs (Q15 or REG_TORQUE
+ * counts); mismatches counts plausibility decisions that differ by more than
+ * the 1 LSB quantisation band around the threshold (should be 0). A row over
+ * its bound is followed by ACCURACY,FAIL,name and the host bench exits 1, so
+ * `pio run -e bench_native` + running the program fails on a regression.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "bamocar-due.h"
+#include "bms_handler.h"
+#include "can_manager.h"
+#include "cycle_counter.h"
+#include "header.h"
+#include <algorithm> // For std::sort
+#include <stdlib.h>  // For exit()
+
+#ifdef VCU_NATIVE
+#include "native_hal.h"
+#endif
+
+#define BENCH_SAMPLES 1000 // Timed calls per benchmark
+#define BENCH_WARMUP 20    // Untimed calls before sampling
+
+// Objects normally defined in main.cpp
+Adafruit_MPU6050 mpu;
+bool mpuInitialized = false;
+
+// Exposes the protected parser for timing
+class BenchBamocar : public Bamocar {
+public:
+  using Bamocar::_parseMessage;
+};
+
+static BenchBamocar bench_bamocar;
+static uint32_t samples[BENCH_SAMPLES];
+static uint32_t counter_overhead = 0;
+
+//------------------------------------------------------------------------------
+// Test Frames
+//------------------------------------------------------------------------------
+static CAN_FRAME make_frame(uint32_t id, uint8_t length, uint8_t b0,
+                            uint8_t b1, uint8_t b2, uint8_t b3, uint8_t b4) {
+  CAN_FRAME frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.id = id;
+  frame.length = length;
+  frame.data.bytes[0] = b0;
+  frame.data.bytes[1] = b1;
+  frame.data.bytes[2] = b2;
+  frame.data.bytes[3] = b3;
+  frame.data.bytes[4] = b4;
+  return frame;
+}
+
+// Plausible BMS broadcasts: SOC 80%, DCL 200 A, cells ~3.8 V / CCL 40 A, 400 V
+static CAN_FRAME bms_frame_1() {
+  CAN_FRAME f = make_frame(ORION_BMS_ID_1, 8, 160, 200, 0, 25, 0x70);
+  f.data.bytes[5] = 0x94;
+  f.data.bytes[6] = 0x70;
+  f.data.bytes[7] = 0x94;
+  return f;
+}
+
+static CAN_FRAME bms_frame_2() {
+  CAN_FRAME f = make_frame(ORION_BMS_ID_2, 8, 40, 0, 0xA0, 0x0F, 0);
+  f.data.bytes[6] = 0x70;
+  f.data.bytes[7] = 0x94;
+  return f;
+}
+
+// Orion cell broadcast: cell 17 at 3.812 V, 1.23 mOhm, not shunting
+static CAN_FRAME bms_cell_frame() {
+  CAN_FRAME f =
+      make_frame(ORION_CELL_BROADCAST_ID, 8, 17, 0x94, 0xE8, 0x00, 0x7B);
+  uint8_t checksum = (uint8_t)(f.id + f.length);
+  for (uint8_t i = 0; i < 7; i++)
+    checksum += f.data.bytes[i];
+  f.data.bytes[7] = checksum;
+  return f;
+}
+
+static CAN_FRAME bamocar_speed_frame() {
+  return make_frame(BAMOCAR_TX_ID, 3, REG_N_ACTUAL, 0x00, 0x40, 0, 0);
+}
+
+//------------------------------------------------------------------------------
+// Benchmarks (prepare is untimed, body is timed)
+//------------------------------------------------------------------------------
+static void nothing() {}
+
+static void bench_apps() { get_apps_reading(); }
+
+static void bench_apps_q15() { get_apps_reading_q15(); }
+
+// On the host this includes filling and filtering a whole buffer, which the
+// Due does in ADC_Handler; host numbers for APPS/motor control include it too
+static void bench_adc_read() {
+  AdcSnapshot adc;
+  adc_sampler_read(adc);
+}
+
+static void bench_motor_control() { motor_control_update(); }
+
+// Off-throttle regen limit: the exact divide vs the cached envelope (same
+// power and speed bucket as the previous call, the steady-state case)
+static void bench_regen_limit() { regen_torque_limit_q15(60000, 4000, 80); }
+
+static void bench_regen_envelope() { regen_envelope_q15(60000, 4000); }
+
+static void bench_torque_map() { torque_map_lookup_q15(20000, 3000); }
+
+static void bench_bamocar_parse() {
+  static const CAN_FRAME frame = bamocar_speed_frame();
+  bench_bamocar._parseMessage(frame);
+}
+
+static void bench_bms_frame() {
+  static const CAN_FRAME frame = bms_frame_2();
+  can_manager.dispatch_frame(frame);
+}
+
+static void bench_bms_cell_frame() {
+  static const CAN_FRAME frame = bms_cell_frame();
+  can_manager.dispatch_frame(frame);
+}
+
+static void bench_bms_snapshot() {
+  static BMSData snapshot;
+  bms_handler.read_snapshot(snapshot);
+}
+
+static void prepare_rx_burst() {
+  // Typical burst: two BMS broadcasts and two Bamocar replies
+  can_manager.queue_rx_frame(bms_frame_1());
+  can_manager.queue_rx_frame(bms_frame_2());
+  can_manager.queue_rx_frame(bamocar_speed_frame());
+  can_manager.queue_rx_frame(
+      make_frame(BAMOCAR_TX_ID, 5, REG_STATUS, 0x01, 0x00, 0x00, 0x00));
+}
+
+static void bench_process_incoming() { can_manager.process_incoming_messages(); }
+
+typedef struct {
+  const char *name;
+  void (*prepare)();
+  void (*body)();
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"adc_sampler_read", nothing, bench_adc_read},
+    {"get_apps_reading", nothing, bench_apps},
+    {"get_apps_reading_q15", nothing, bench_apps_q15},
+    {"motor_control_update", nothing, bench_motor_control},
+    {"regen_torque_limit_q15", nothing, bench_regen_limit},
+    {"regen_envelope_q15", nothing, bench_regen_envelope},
+    {"torque_map_lookup_q15", nothing, bench_torque_map},
+    {"Bamocar::_parseMessage", nothing, bench_bamocar_parse},
+    {"BMSHandler_frame_dispatch", nothing, bench_bms_frame},
+    {"BMSHandler_cell_frame_dispatch", nothing, bench_bms_cell_frame},
+    {"BMSHandler::read_snapshot", nothing, bench_bms_snapshot},
+    {"CANManager::process_incoming_messages_x4", prepare_rx_burst,
+     bench_process_incoming},
+};
+
+//------------------------------------------------------------------------------
+// Fixed-Point vs Floating-Point Accuracy
+//------------------------------------------------------------------------------
+// Bound for rows that are only informative (neither column is checked)
+#define ACCURACY_REPORT_ONLY (-1)
+
+static uint32_t accuracy_failures = 0;
+
+/**
+ * @brief Prints one ACCURACY line and checks it: max_err must not exceed
+ * max_err_limit and mismatches must be 0, unless the limit is
+ * ACCURACY_REPORT_ONLY.
+ */
+static void print_accuracy(const char *name, uint32_t cases, int32_t max_err,
+                           uint32_t mismatches, int32_t max_err_limit) {
+  Serial.print("ACCURACY,");
+  Serial.print(name);
+  Serial.print(",");
+  Serial.print(cases);
+  Serial.print(",");
+  Serial.print(max_err);
+  Serial.print(",");
+  Serial.println(mismatches);
+  if (max_err_limit != ACCURACY_REPORT_ONLY &&
+      (max_err > max_err_limit || mismatches > 0)) {
+    Serial.print("ACCURACY,FAIL,");
+    Serial.println(name);
+    accuracy_failures++;
+  }
+}
+
+static int32_t abs_diff(int32_t a, int32_t b) { return a > b ? a - b : b - a; }
+
+#ifdef VCU_NATIVE
+#define ADC_RAW_MAX ((1 << ADC_SAMPLER_BITS) - 1) // set_analog() full scale
+
+// Sets both APPS inputs (raw 12-bit) and reads twice so the median history
+// holds only the new values; the next reads then see a settled filter.
+static void set_apps_raw(int32_t raw_1, int32_t raw_2) {
+  AdcSnapshot adc;
+  native_hal::set_analog(APPS_1_PIN, raw_1);
+  native_hal::set_analog(APPS_2_PIN, raw_2);
+  adc_sampler_read(adc);
+  adc_sampler_read(adc);
+}
+
+// Both sensors over the full 12-bit input range, with deviations either side
+// of the 10% plausibility threshold (~223 counts)
+static void check_apps_accuracy() {
+  uint32_t cases = 0, mismatches = 0;
+  int32_t max_err = 0;
+  native_hal::set_serial_echo(false); // Implausibility prints are expected
+  for (int32_t raw_1 = 0; raw_1 <= ADC_RAW_MAX; raw_1 += 3) {
+    for (int32_t delta = -320; delta <= 320; delta += 8) {
+      int32_t raw_2 = raw_1 + delta;
+      if (raw_2 < 0 || raw_2 > ADC_RAW_MAX)
+        continue;
+      set_apps_raw(raw_1, raw_2);
+      double reference = get_apps_reading();
+      q15_t fixed = get_apps_reading_q15();
+      cases++;
+
+      if ((reference < 0.0) != (fixed < 0)) {
+        // Only a mismatch if the deviation is clearly away from the threshold
+        set_apps_raw(raw_1, raw_1);
+        double p1 = get_apps_reading();
+        set_apps_raw(raw_2, raw_2);
+        double p2 = get_apps_reading();
+        double deviation_lsb = (p1 > p2 ? p1 - p2 : p2 - p1) * 327.68;
+        if (abs_diff((int32_t)(deviation_lsb + 0.5),
+                     APPS_PLAUSIBILITY_THRESHOLD_Q15) > 1)
+          mismatches++;
+        continue;
+      }
+      if (fixed >= 0) {
+        int32_t expected = (int32_t)(reference * 327.68 + 0.5);
+        if (expected > Q15_ONE)
+          expected = Q15_ONE;
+        int32_t err = abs_diff(fixed, expected);
+        if (err > max_err)
+          max_err = err;
+      }
+    }
+  }
+  set_apps_raw(2820, 2820);
+  native_hal::set_serial_echo(true);
+  print_accuracy("get_apps_reading_q15", cases, max_err, mismatches, 2);
+}
+
+// Full-scale single-sample spikes on APPS 1 every 7th read: max_err is the
+// worst pedal error they cause, mismatches the implausibilities they trip
+// (both 0 with ADC_MEDIAN_REJECTION)
+static uint32_t spiky_apps_script(uint32_t pin, unsigned long now_us) {
+  static uint32_t calls = 0;
+  (void)now_us;
+  if (pin == (uint32_t)APPS_1_PIN && (++calls % 7) == 0)
+    return ADC_RAW_MAX;
+  return pin == (uint32_t)BRAKE_PRESSURE_SENSOR_PIN ? 400 : 2820;
+}
+
+static void check_adc_spike_rejection() {
+  uint32_t cases = 0, mismatches = 0;
+  int32_t max_err = 0;
+  set_apps_raw(2820, 2820);
+  q15_t clean = get_apps_reading_q15();
+  native_hal::set_analog_script(spiky_apps_script);
+  native_hal::set_serial_echo(false);
+  for (uint16_t i = 0; i < 1000; i++) {
+    q15_t reading = get_apps_reading_q15();
+    if (reading < 0) {
+      mismatches++;
+    } else {
+      int32_t err = abs_diff(reading, clean);
+      if (err > max_err)
+        max_err = err;
+    }
+    cases++;
+  }
+  native_hal::set_serial_echo(true);
+  native_hal::set_analog_script(nullptr);
+  set_apps_raw(2820, 2820);
+  // Without the median filter the spikes get through: report only
+  print_accuracy("adc_spike_rejection", cases, max_err, mismatches,
+                 ADC_MEDIAN_REJECTION ? 0 : ACCURACY_REPORT_ONLY);
+}
+
+// Every Q15 command -> REG_TORQUE, against setTorque(float)
+static void check_torque_register_accuracy() {
+  CAN_FRAME sent;
+  uint32_t cases = 0;
+  int32_t max_err = 0;
+  while (native_hal::can_pop_sent(sent))
+    ;
+  for (int32_t q = Q15_MIN; q <= Q15_ONE; q += 7) {
+    bamocar.setTorqueQ15((q15_t)q);
+    if (!native_hal::can_pop_sent(sent))
+      continue;
+    int32_t fixed = (int16_t)(sent.data.bytes[1] | (sent.data.bytes[2] << 8));
+    int32_t expected = (int32_t)((float)q / 32768.0f * 32760.0f);
+    int32_t err = abs_diff(fixed, expected);
+    if (err > max_err)
+      max_err = err;
+    cases++;
+  }
+  print_accuracy("Bamocar::setTorqueQ15", cases, max_err, 0, 1);
+}
+#endif
+
+// Regen limit over CCL, pack voltage and speed, against the float formula.
+// The factor is rounded down, so a mismatch is a limit above the float one.
+static void check_regen_accuracy() {
+  uint32_t cases = 0;
+  uint32_t mismatches = 0;
+  int32_t max_err = 0;
+  const int32_t max_torque_nm = 80;
+  for (int32_t ccl = 1; ccl <= 200; ccl += 7) {
+    for (int32_t volts = 250; volts <= 600; volts += 50) {
+      for (int32_t rpm = 101; rpm <= 8000; rpm += 97) {
+        int32_t power_w = ccl * volts;
+        float rad_s = (float)rpm * (2.0f * PI / 60.0f);
+        float limit = ((float)power_w / rad_s) / (float)max_torque_nm;
+        int32_t expected =
+            limit >= 1.0f ? Q15_ONE : (int32_t)(limit * 32768.0f + 0.5f);
+        int32_t limit_q15 =
+            regen_torque_limit_q15(power_w, rpm, max_torque_nm);
+        int32_t err = abs_diff(limit_q15, expected);
+        if (err > max_err)
+          max_err = err;
+        if (limit_q15 > expected)
+          mismatches++;
+        cases++;
+      }
+    }
+  }
+  print_accuracy("regen_torque_limit_q15", cases, max_err, mismatches, 16);
+}
+
+// Cached envelope against the same formula. It rounds every speed up to its
+// bucket's top edge, so the error is large but must never be above: a
+// mismatch is a limit higher than the exact one.
+static void check_regen_envelope_accuracy() {
+  uint32_t cases = 0;
+  uint32_t mismatches = 0;
+  int32_t max_err = 0;
+  const int32_t max_torque_nm = 80;
+  for (int32_t ccl = 1; ccl <= 200; ccl += 7) {
+    for (int32_t volts = 250; volts <= 600; volts += 50) {
+      for (int32_t rpm = 101; rpm <= 9000; rpm += 97) {
+        int32_t power_w = ccl * volts;
+        float rad_s = (float)rpm * (2.0f * PI / 60.0f);
+        float limit = ((float)power_w / rad_s) / (float)max_torque_nm;
+        int32_t expected =
+            limit >= 1.0f ? Q15_ONE : (int32_t)(limit * 32768.0f + 0.5f);
+        int32_t envelope = regen_envelope_q15(power_w, rpm);
+        int32_t err = abs_diff(envelope, expected);
+        if (err > max_err)
+          max_err = err;
+        if (envelope > expected)
+          mismatches++;
+        cases++;
+      }
+    }
+  }
+  // Error is by design (bucket rounding); only the upper bound is checked
+  print_accuracy("regen_envelope_q15", cases, max_err, mismatches, Q15_ONE);
+}
+
+// Torque maps: the linear acceleration profile against torque = pedal, and
+// every profile for torque that drops as the pedal goes down (a mismatch)
+static void check_torque_map_accuracy() {
+  uint32_t cases = 0;
+  uint32_t mismatches = 0;
+  int32_t max_err = 0;
+  for (int profile = 0; profile < TORQUE_PROFILE_COUNT; profile++) {
+    torque_map_select((TorqueProfile)profile);
+    torque_map_apply_pending();
+    for (int32_t rpm = -1000; rpm <= 9000; rpm += 37) {
+      q15_t last = 0;
+      for (int32_t pedal = 0; pedal <= Q15_ONE; pedal += 13) {
+        q15_t torque = torque_map_lookup_q15((q15_t)pedal, rpm);
+        if (torque < last)
+          mismatches++;
+        last = torque;
+        if (profile == TORQUE_PROFILE_ACCELERATION) {
+          int32_t err = abs_diff(torque, pedal);
+          if (err > max_err)
+            max_err = err;
+        }
+        cases++;
+      }
+    }
+  }
+  torque_map_select(TORQUE_MAP_DEFAULT_PROFILE);
+  torque_map_apply_pending();
+  print_accuracy("torque_map_lookup_q15", cases, max_err, mismatches, 1);
+}
+
+static void check_accuracy() {
+  Serial.println("ACCURACY,name,cases,max_err_lsb,mismatches");
+#ifdef VCU_NATIVE
+  check_apps_accuracy();
+  check_adc_spike_rejection();
+  check_torque_register_accuracy();
+#endif
+  check_regen_accuracy();
+  check_regen_envelope_accuracy();
+  check_torque_map_accuracy();
+}
+
+//------------------------------------------------------------------------------
+// Runner
+//------------------------------------------------------------------------------
+static uint32_t percentile(uint32_t p) {
+  uint32_t index = (uint32_t)(((uint64_t)p * (BENCH_SAMPLES - 1)) / 100);
+  return samples[index];
+}
+
+static void run_benchmark(const Benchmark &bench) {
+  for (uint16_t i = 0; i < BENCH_WARMUP; i++) {
+    bench.prepare();
+    bench.body();
+  }
+
+  for (uint16_t i = 0; i < BENCH_SAMPLES; i++) {
+    bench.prepare();
+    uint32_t start = cycle_counter_read();
+    bench.body();
+    uint32_t elapsed = cycle_counter_read() - start;
+    samples[i] = elapsed > counter_overhead ? elapsed - counter_overhead : 0;
+#ifdef VCU_NATIVE
+    native_hal::advance_millis(1); // Let millis()-based logic progress
+#endif
+  }
+
+  std::sort(samples, samples + BENCH_SAMPLES);
+
+#ifdef VCU_NATIVE
+  native_hal::set_serial_echo(true);
+#endif
+  Serial.print("BENCH,");
+  Serial.print(bench.name);
+  Serial.print(",");
+  Serial.print(CYCLE_COUNTER_UNIT);
+  Serial.print(",");
+  Serial.print(BENCH_SAMPLES);
+  Serial.print(",");
+  Serial.print(samples[0]);
+  Serial.print(",");
+  Serial.print(percentile(50));
+  Serial.print(",");
+  Serial.print(percentile(99));
+  Serial.print(",");
+  Serial.println(samples[BENCH_SAMPLES - 1]);
+#ifdef VCU_NATIVE
+  native_hal::set_serial_echo(false); // Hide DEBUG_MODE prints while timing
+#endif
+}
+
+static void calibrate_overhead() {
+  uint32_t best = 0xFFFFFFFFu;
+  for (uint16_t i = 0; i < 100; i++) {
+    uint32_t start = cycle_counter_read();
+    uint32_t elapsed = cycle_counter_read() - start;
+    if (elapsed < best)
+      best = elapsed;
+  }
+  counter_overhead = best;
+}
+
+//------------------------------------------------------------------------------
+// SETUP / LOOP
+//------------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  while (!Serial && millis() < 5000)
+    ;
+
+#ifdef VCU_NATIVE
+  // Pedal at ~50% on both sensors, brake released
+  native_hal::set_analog(APPS_1_PIN, 2820);
+  native_hal::set_analog(APPS_2_PIN, 2820);
+  native_hal::set_analog(BRAKE_PRESSURE_SENSOR_PIN, 400);
+#endif
+
+  adc_sampler_begin();
+  motor_control_begin();
+
+  bamocar.registerCANHandler(can_manager);
+  bms_handler.register_can_handlers(can_manager);
+  can_manager.initialize(CAN_BPS_500K);
+
+  // Give the control path valid BMS data and a motor speed
+  can_manager.dispatch_frame(bms_frame_1());
+  can_manager.dispatch_frame(bms_frame_2());
+  can_manager.dispatch_frame(bamocar_speed_frame());
+
+  check_accuracy();
+  if (accuracy_failures > 0) {
+    Serial.print("ACCURACY,failed,");
+    Serial.println(accuracy_failures);
+#ifdef VCU_NATIVE
+    exit(1); // Fails the host run (flushes stdout)
+#endif
+  }
+
+  cycle_counter_init();
+  calibrate_overhead();
+
+  Serial.println("BENCH,name,unit,samples,min,median,p99,max");
+#ifdef VCU_NATIVE
+  native_hal::set_serial_echo(false);
+#endif
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+    run_benchmark(benchmarks[i]);
+  }
+#ifdef VCU_NATIVE
+  native_hal::set_serial_echo(true);
+#endif
+  Serial.println("BENCH,done");
+}
+
+void loop() {}
@@ -0,0 +1,100 @@
+/**
+ * @file adc_sampler.h
+ * @brief Free-running ADC sampling of the APPS and brake pressure channels.
+ * On the Due the SAM3X ADC scans A7/A6/A0 continuously at 12 bits and the
+ * PDC (DMA) fills a double buffer. Each buffer holds ADC_OVERSAMPLE_FACTOR
+ * scans; the ADC interrupt runs every channel through an optional median-of-3
+ * spike filter, averages (decimates) the buffer and publishes the result at
+ * 16-bit scale. Readers get a coherent snapshot without blocking, with both
+ * APPS sensors filtered over the same time window.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Measure the actual scan rate on the car (toggle a pin in ADC_Handler) and
+//   update ADC_SAMPLER_SCAN_RATE_HZ if the datasheet estimate is off.
+// - Review source impedance of the APPS/brake sensors against the tracking
+//   time (ADC_MR TRACKTIM) if readings look low or channels bleed together.
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+
+//------------------------------------------------------------------------------
+// Filter Configuration (override with -D in platformio.ini build_flags)
+//------------------------------------------------------------------------------
+// Scans averaged into one output sample. Averaging N samples cuts white noise
+// by sqrt(N). 16 gives an output just above the 1 kHz control rate.
+#ifndef ADC_OVERSAMPLE_FACTOR
+#define ADC_OVERSAMPLE_FACTOR 16
+#endif
+
+// 1: replace every raw sample by the median of it and its two predecessors
+// before averaging, so a single-sample spike never reaches the output.
+// Costs one sample of delay.
+#ifndef ADC_MEDIAN_REJECTION
+#define ADC_MEDIAN_REJECTION 1
+#endif
+
+#define ADC_SAMPLER_BITS 12         // Hardware resolution
+#define ADC_SAMPLER_OUTPUT_SHIFT 4  // Output is scaled up to 16 bits
+#define ADC_SAMPLER_MAX_VALUE 65520 // Full scale of AdcSnapshot (4095 << 4)
+#define ADC_SAMPLER_NUM_CHANNELS 3  // APPS 1, APPS 2, brake pressure
+
+// ADC clock = MCK / ((PRESCAL + 1) * 2) = 84 MHz / 80 = 1.05 MHz. A SAM3X
+// conversion takes ~20 ADC clocks, so 52.5 kS/s shared by the 3 channels.
+#define ADC_SAMPLER_PRESCAL 39
+#define ADC_SAMPLER_CLOCK_HZ (84000000UL / ((ADC_SAMPLER_PRESCAL + 1) * 2))
+#define ADC_SAMPLER_SCAN_RATE_HZ                                               \
+  (ADC_SAMPLER_CLOCK_HZ / 20 / ADC_SAMPLER_NUM_CHANNELS) // ~17.5 kHz
+
+// One output sample per DMA buffer of ADC_OVERSAMPLE_FACTOR scans
+// (16: ~1.09 kHz).
+#define ADC_SAMPLER_OUTPUT_RATE_HZ                                             \
+  (ADC_SAMPLER_SCAN_RATE_HZ / ADC_OVERSAMPLE_FACTOR)
+
+// Group delay of the filter: the boxcar average is centred (N - 1) / 2 scans
+// before the newest sample, plus one scan for the median (16: ~430 us).
+#define ADC_SAMPLER_GROUP_DELAY_US                                             \
+  (((ADC_OVERSAMPLE_FACTOR - 1) * 500000UL +                                   \
+    (ADC_MEDIAN_REJECTION ? 1000000UL : 0)) /                                  \
+   ADC_SAMPLER_SCAN_RATE_HZ)
+
+// Worst-case age of a snapshot's signal: group delay plus up to one output
+// period waiting for the next publish (16: ~1.35 ms).
+#define ADC_SAMPLER_MAX_AGE_US                                                 \
+  (ADC_SAMPLER_GROUP_DELAY_US + 1000000UL / ADC_SAMPLER_OUTPUT_RATE_HZ)
+
+// One filtered output sample, 0 to ADC_SAMPLER_MAX_VALUE.
+typedef struct {
+  uint16_t apps_1;         // APPS_1_PIN
+  uint16_t apps_2;         // APPS_2_PIN
+  uint16_t brake_pressure; // BRAKE_PRESSURE_SENSOR_PIN
+  uint32_t sequence;       // Outputs published so far (changes with each)
+  uint32_t timestamp_us;   // micros() when the sample was published
+} AdcSnapshot;
+
+/**
+ * @brief Starts free-running sampling. After this, analogRead() must not be
+ * used on any pin (it would reprogram the ADC under the DMA).
+ * @return True if the ADC and DMA were configured.
+ */
+bool adc_sampler_begin();
+
+/**
+ * @brief Copies the newest filtered sample set. Never blocks; if the
+ * interrupt publishes a new one mid-copy, the copy is simply retried.
+ * @param snapshot Output.
+ * @return False if no output is available yet (snapshot is then all zero).
+ */
+bool adc_sampler_read(AdcSnapshot &snapshot);
+
+/**
+ * @brief Number of buffers dropped because the ADC overran (a channel was
+ * converted again before the DMA read it). Should stay at 0.
+ */
+uint32_t adc_sampler_get_overrun_count();
+
+#endif // ADC_SAMPLER_H
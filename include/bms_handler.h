@@ -1,7 +1,9 @@
 /**
  * @file bms_handler.h
  * @brief Defines the BMSHandler class for processing Orion BMS 2 CAN messages
- * and storing the relevant battery status.
+ * and storing the relevant battery status. Decoded frames are published
+ * through a double buffer guarded by a sequence word, so readers in any
+ * context get a coherent copy without masking interrupts.
  * NOTE: Parsing logic is a placeholder and MUST be updated based on
  * actual BMS configuration and CAN specification.
  * @author Shane Whelan (UCD Formula Student)
@@ -12,13 +14,41 @@
 // - Review and update the BMSData struct fields to match the exact data
 //   you need from your Orion BMS 2 configuration.
 // - Ensure placeholder comments reflect the actual implementation status.
+// - Set BMS_NUM_CELLS / BMS_NUM_THERMISTORS to the accumulator and check
+//   dbc/vcu.dbc against the Orion utility's CAN export.
 
 #ifndef BMS_HANDLER_H
 #define BMS_HANDLER_H
 
+#include "can_signals.h"
+#include "min_max_tree.h"
 #include <due_can.h> // For CAN_FRAME type
 #include <stdint.h>
 
+class CANManager; // Forward declaration (can_manager.h includes this header)
+
+// Orion BMS broadcast IDs. IDs and signal layouts live in dbc/vcu.dbc (decoders
+// in can_signals.h); update them there to match the Orion utility's export.
+// Each ID must also have a row in BMSHandler::register_can_handlers().
+#define ORION_BMS_ID_1 can_signals::OrionPack1::ID
+#define ORION_BMS_ID_2 can_signals::OrionPack2::ID
+// Per-cell broadcast, one cell per frame: cell ID, instant voltage (0.1 mV),
+// internal resistance (0.01 mOhm, bit 15 = shunting), open voltage, checksum
+#define ORION_CELL_BROADCAST_ID can_signals::OrionCellBroadcast::ID
+// Thermistor expansion module, one thermistor per frame (29-bit ID)
+#define ORION_THERMISTOR_BROADCAST_ID can_signals::OrionThermistorBroadcast::ID
+
+// Accumulator size: one slot per cell / thermistor broadcast by the BMS
+#define BMS_NUM_CELLS 96       // Series cells - Verify!
+#define BMS_NUM_THERMISTORS 48 // Enabled thermistors - Verify!
+
+// No BMS message for this long = communication fault (Rule EV5.8.10)
+#define BMS_COMM_TIMEOUT_MS 1000
+
+// Copies read_snapshot() attempts before giving up. A retry only happens if
+// a publish lands mid-copy, so more than one is already rare.
+#define BMS_SNAPSHOT_MAX_TRIES 3
+
 // Structure to hold BMS data
 // TODO: Verify/Add/Remove fields as needed based on your requirements and BMS
 // config
@@ -43,6 +73,22 @@ typedef struct {
   int8_t low_temperature;  // Lowest cell temperature (°C)
   int8_t avg_temperature;  // Average cell temperature (°C)
 
+  // Per-cell summary from the cell / thermistor broadcasts, kept up to date
+  // frame by frame (per-cell values: BMSHandler::get_cell_mv() etc.)
+  uint16_t cell_min_mv;       // Lowest reported cell
+  uint16_t cell_max_mv;       // Highest reported cell
+  uint16_t cell_avg_mv;       // Mean of the reported cells
+  uint16_t cell_imbalance_mv; // cell_max_mv - cell_min_mv
+  uint8_t cell_min_id;        // Cell holding the minimum (0-based)
+  uint8_t cell_max_id;        // Cell holding the maximum
+  uint8_t cells_reported;     // Cells heard from (of BMS_NUM_CELLS)
+  uint8_t cells_shunting;     // Cells balancing right now
+  int8_t thermistor_min_c;
+  int8_t thermistor_max_c;
+  int8_t thermistor_avg_c;
+  uint8_t thermistor_max_id;    // Hottest thermistor (0-based)
+  uint8_t thermistors_reported; // Of BMS_NUM_THERMISTORS
+
   // Faults / Status Flags (Use appropriate types, e.g., bitfields or enums)
   // TODO: Replace these examples with actual fault flags/codes from BMS CAN
   // spec
@@ -57,6 +103,9 @@ typedef struct {
   // health)
   unsigned long last_message_millis;
 
+  // Publish count when this copy was taken (see BMSHandler::read_snapshot())
+  uint32_t generation;
+
 } BMSData;
 
 class BMSHandler {
@@ -67,24 +116,61 @@ public:
   BMSHandler();
 
   /**
-   * @brief Processes an incoming CAN frame potentially containing BMS data.
-   * Decodes the data based on the CAN ID and updates the internal state.
-   * *** THIS IS A PLACEHOLDER - IMPLEMENT ACTUAL DECODING ***
-   * @param frame The received CAN_FRAME.
+   * @brief Claims every Orion BMS broadcast ID this handler decodes in the
+   * CANManager dispatch registry. Call before CANManager::initialize().
+   * @param can The CANManager that receives the frames.
+   * @return True if all IDs were registered.
+   */
+  bool register_can_handlers(CANManager &can);
+
+  /**
+   * @brief Copies the latest published BMS data. Lock-free and safe from any
+   * context: copies the front buffer, then checks the sequence word has not
+   * moved, retrying at most BMS_SNAPSHOT_MAX_TRIES times (one struct copy
+   * each).
+   * @param snapshot Output; snapshot.generation says which publish it is.
+   * @return False if every attempt raced a publish (snapshot then holds a
+   * torn copy: keep using the previous one).
    */
-  void handle_incoming_frame(const CAN_FRAME &frame);
+  bool read_snapshot(BMSData &snapshot) const;
 
   /**
-   * @brief Gets the current BMS data.
-   * @return A constant reference to the internal BMSData struct.
+   * @brief Publish count: changes whenever a frame or the supervision task
+   * changes the data. One load; compare with a saved value (or
+   * BMSData::generation) to skip work when nothing changed.
    */
-  const BMSData &get_bms_data() const;
+  uint32_t get_generation() const { return state >> 1; }
+
+  // Latest per-cell values (0-based index; 0 until first reported). Each is
+  // one load of a value the RX path replaces whole, so safe from any context.
+  uint16_t get_cell_mv(uint8_t cell) const {
+    return cell < BMS_NUM_CELLS ? cell_mv.get(cell) : 0;
+  }
+  // Internal resistance in 0.01 mOhm
+  uint16_t get_cell_resistance(uint8_t cell) const {
+    return cell < BMS_NUM_CELLS ? cell_resistance[cell] : 0;
+  }
+  bool is_cell_shunting(uint8_t cell) const {
+    return cell < BMS_NUM_CELLS &&
+           ((shunting_bits[cell >> 3] >> (cell & 7)) & 1u);
+  }
+  int8_t get_thermistor_c(uint8_t thermistor) const {
+    return thermistor < BMS_NUM_THERMISTORS ? thermistor_c.get(thermistor)
+                                            : 0;
+  }
 
   /**
    * @brief Checks if the BMS is reporting any critical faults.
    * *** THIS IS A PLACEHOLDER - IMPLEMENT ACTUAL FAULT CHECKING ***
+   * @param data Snapshot to check (from read_snapshot()).
    * @return True if a critical fault is active, false otherwise.
    */
+  static bool has_critical_fault(const BMSData &data);
+
+  /**
+   * @brief Same, on a fresh snapshot. A snapshot that cannot be taken counts
+   * as a fault.
+   */
   bool has_critical_fault() const;
 
   /**
@@ -93,10 +179,75 @@ public:
    * message.
    * @return True if communication is active, false otherwise.
    */
-  bool is_communication_active(unsigned long timeout_ms = 1000) const;
+  bool is_communication_active(
+      unsigned long timeout_ms = BMS_COMM_TIMEOUT_MS) const;
+
+  /**
+   * @brief Periodic supervision (scheduler task, 50 Hz). Sets
+   * communication_fault once no BMS message has arrived for timeout_ms, so
+   * has_critical_fault() reports a silent BMS even when no frames arrive to
+   * trigger an update. The next received frame clears it again.
+   * @param timeout_ms The maximum allowed time since the last message.
+   */
+  void update_supervision(unsigned long timeout_ms = BMS_COMM_TIMEOUT_MS);
 
 private:
-  BMSData current_bms_data; // Internal storage for BMS state
+  // Writer's copy: parsers update it field by field, publish() copies it
+  // into the back buffer. Only the CAN RX path (and the supervision task,
+  // under a CriticalSection) touches it.
+  BMSData working;
+  BMSData buffers[2];
+  // (generation << 1) | front buffer index. One store publishes both.
+  volatile uint32_t state;
+
+  /**
+   * @brief Copies working into the back buffer, then flips the front index
+   * and bumps the generation in a single store.
+   */
+  void publish();
+
+  // Cell-level model, written by the RX path only. The trees keep min/max
+  // and sums current on every frame; publish() carries the summary out.
+  MinMaxTree<uint16_t, BMS_NUM_CELLS> cell_mv;
+  MinMaxTree<int8_t, BMS_NUM_THERMISTORS> thermistor_c;
+  uint16_t cell_resistance[BMS_NUM_CELLS]; // 0.01 mOhm
+  uint8_t shunting_bits[(BMS_NUM_CELLS + 7) / 8];
+  uint8_t shunting_count;
+
+  /**
+   * @brief Copies the tree roots and sums into working's cell summary.
+   */
+  void update_cell_summary();
+
+  /**
+   * @brief Orion per-cell broadcast (ORION_CELL_BROADCAST_ID).
+   * @param frame The received CAN_FRAME with matching ID.
+   */
+  void parse_cell_broadcast(const CAN_FRAME &frame);
+
+  /**
+   * @brief Thermistor expansion module broadcast
+   * (ORION_THERMISTOR_BROADCAST_ID).
+   * @param frame The received CAN_FRAME with matching ID.
+   */
+  void parse_thermistor_broadcast(const CAN_FRAME &frame);
+
+  /**
+   * @brief CANManager entry point for one BMS message ID. Each registered ID
+   * gets its own instantiation, so dispatch goes straight to the parser.
+   * @tparam Parse The parse_bms_message_X function for this ID.
+   * @param frame The received CAN_FRAME.
+   * @param context The BMSHandler instance.
+   */
+  template <void (BMSHandler::*Parse)(const CAN_FRAME &)>
+  static void rx_trampoline(const CAN_FRAME &frame, void *context);
+
+  /**
+   * @brief Re-evaluates the voltage/temperature fault flags after a frame has
+   * been parsed.
+   * *** THIS IS A PLACEHOLDER - IMPLEMENT ACTUAL FAULT LOGIC ***
+   */
+  void update_fault_flags();
 
   /**
    * @brief Placeholder function to parse BMS message ID 1 (e.g., 0x420).
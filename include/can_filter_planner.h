@@ -0,0 +1,56 @@
+/**
+ * @file can_filter_planner.h
+ * @brief Packs a set of wanted CAN IDs into the limited number of SAM3X
+ * mailbox ID/mask filters, keeping the number of unwanted IDs that get
+ * through the hardware as low as possible.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef CAN_FILTER_PLANNER_H
+#define CAN_FILTER_PLANNER_H
+
+#include <stdint.h>
+
+#define CAN_FILTER_PLAN_MAX 8 // One filter per SAM3X mailbox at most
+
+// A set of wanted IDs: every ID where (rx_id & mask) == id.
+// Groups passed to the planner must not overlap (CANManager guarantees this).
+typedef struct {
+  uint32_t id;
+  uint32_t mask;
+  bool extended;
+} CanFilterGroup;
+
+// One planned hardware filter (one mailbox).
+typedef struct {
+  uint32_t id;
+  uint32_t mask;
+  bool extended;
+  uint32_t admitted; // Number of distinct IDs the filter lets through
+  uint32_t unwanted; // Of those, IDs nobody registered for
+} CanFilter;
+
+typedef struct {
+  uint8_t count;           // Filters used (mailboxes needed)
+  uint32_t total_unwanted; // Sum of unwanted IDs over all filters
+  CanFilter filters[CAN_FILTER_PLAN_MAX];
+} CanFilterPlan;
+
+/**
+ * @brief Computes ID/mask filters covering every wanted group.
+ * Standard-ID groups are merged greedily, always picking the merge that adds
+ * the fewest unwanted IDs, until they fit in max_filters. Merges that add no
+ * unwanted IDs at all (e.g. 0x420 + 0x421 -> 0x420/0x7FE) are always taken,
+ * so the plan also uses as few mailboxes as possible. Extended-ID groups are
+ * kept as registered.
+ * @param groups The wanted ID groups.
+ * @param group_count Number of entries in groups.
+ * @param max_filters Mailboxes available (<= CAN_FILTER_PLAN_MAX).
+ * @param plan Output plan.
+ * @return True if a plan fitting max_filters was found.
+ */
+bool plan_can_filters(const CanFilterGroup *groups, uint8_t group_count,
+                      uint8_t max_filters, CanFilterPlan &plan);
+
+#endif // CAN_FILTER_PLANNER_H
@@ -10,16 +10,93 @@
 #ifndef CAN_MANAGER_H
 #define CAN_MANAGER_H
 
+#include "can_filter_planner.h"
 #include "header.h" // Include common headers/constants
 #include <due_can.h>
 
 // Define expected CAN IDs (Update these based on actual configuration)
-#define BAMOCAR_RX_ID 0x201  // Default Bamocar receive ID (we send to this)
-#define BAMOCAR_TX_ID 0x181  // Default Bamocar transmit ID (we receive this)
-#define ORION_BMS_ID_1 0x420 // Example BMS ID 1 (Needs verification)
-#define ORION_BMS_ID_2 0x421 // Example BMS ID 2 (Needs verification)
+// Node-specific IDs (e.g. ORION_BMS_ID_x) live with the handler that claims
+// them, see register_rx_handler().
+#define BAMOCAR_RX_ID 0x201 // Default Bamocar receive ID (we send to this)
+#define BAMOCAR_TX_ID 0x181 // Default Bamocar transmit ID (we receive this)
 // Add other necessary CAN IDs here
 
+// --- RX dispatch registry ---
+#define CAN_STD_ID_MASK 0x7FF    // 11-bit standard identifier
+#define CAN_STD_ID_COUNT 2048    // Size of the standard ID lookup table
+#define CAN_MAX_RX_HANDLERS 32   // Max registrations (IDs or ID/mask pairs)
+#define CAN_NUM_MAILBOXES 8      // SAM3X CAN0 mailboxes
+#define CAN_NUM_TX_MAILBOXES 1   // Mailboxes reserved for transmit
+#define CAN_NUM_RX_MAILBOXES (CAN_NUM_MAILBOXES - CAN_NUM_TX_MAILBOXES)
+
+// --- TX queue ---
+#define CAN_TX_QUEUE_DEPTH 16     // Frames per priority class
+#define CAN_TX_MAILBOX (CAN_NUM_MAILBOXES - 1) // Mailbox used for transmit
+#define CAN_TX_NO_COALESCE 0xFFFF // Coalesce key: never replace queued frames
+
+// Transmit priority classes, highest first. Lower classes only go out when
+// every higher class is empty.
+enum CanTxPriority {
+  CAN_TX_PRIORITY_SETPOINT = 0, // Torque/enable commands to the inverter
+  CAN_TX_PRIORITY_REQUEST,      // Status/data requests
+  CAN_TX_PRIORITY_TELEMETRY,    // Diagnostics and logging
+  CAN_TX_PRIORITY_COUNT
+};
+
+// --- Bus instrumentation ---
+// Load is "VCU-visible": only frames our mailbox filters admit plus our own
+// TX are counted, so it is a lower bound on the real bus utilisation
+// (traffic between other nodes is invisible). Use a bus analyser for that.
+#define CAN_BUS_BITRATE 500000   // Must match initialize() baudrate for load %
+#define CAN_STATS_MAX_IDS 32     // Tracked IDs (power of two, hashed)
+#define CAN_DIAG_TX_ID 0x7E0     // Diagnostic frame published by the VCU
+#define CAN_DIAG_PERIOD_MS 1000  // Diagnostic frame / load window period
+
+// Per-ID traffic counters. Intervals are between consecutive RX frames of the
+// same ID, mean and jitter are running averages (1/16 weight).
+typedef struct {
+  uint32_t id;       // CAN ID
+  bool extended;     // 29-bit ID
+  bool in_use;       // Slot allocated
+  uint32_t rx_count; // Frames received (dispatched)
+  uint32_t tx_count; // Frames handed to the hardware
+  uint32_t last_rx_us;
+  uint32_t min_interval_us;
+  uint32_t max_interval_us;
+  uint32_t mean_interval_us; // Running average inter-arrival time
+  uint32_t jitter_us;        // Running average of |interval - mean|
+} CanIdStats;
+
+// Bus-wide counters. The *_window fields cover the last completed
+// CAN_DIAG_PERIOD_MS window, everything else is since startup.
+typedef struct {
+  uint32_t rx_frames;
+  uint32_t tx_frames;
+  uint32_t rx_overflows;          // Dropped because the RX ring was full
+  uint32_t rx_unclaimed;          // Admitted by a mailbox but no handler
+  uint32_t tx_drops;              // Rejected because a TX class was full
+  uint32_t tx_failures;           // Can0.sendFrame() refused the frame
+  uint32_t tx_coalesced;          // Replaced in the queue by a newer frame
+  uint32_t untracked_ids;         // Frames whose ID did not fit the stats table
+  uint32_t max_rx_latency_us;     // Worst ISR-to-dispatch delay
+  uint16_t rx_high_water;         // Most frames waiting in the RX ring
+  uint16_t visible_load_permille; // VCU-visible load, 0.1% units (window)
+  uint32_t rx_frames_window;
+  uint32_t tx_frames_window;
+} CanBusStats;
+
+/**
+ * @brief Handler called for every received frame whose ID was claimed with
+ * CANManager::register_rx_handler().
+ * @param frame The received CAN_FRAME.
+ * @param context The pointer given at registration (usually the owning object).
+ */
+typedef void (*CanRxHandler)(const CAN_FRAME &frame, void *context);
+
+// RX ring buffer capacity (frames). Must be a power of two so the indices can
+// wrap with a mask. Size it from get_rx_high_water() on real bus traffic.
+#define CAN_RX_RING_SIZE 64
+
 class CANManager {
 public:
   /**
@@ -35,27 +112,264 @@ public:
   bool initialize(uint32_t baudrate);
 
   /**
-   * @brief Processes incoming CAN messages from the hardware buffer.
-   * This should be called frequently in the main loop.
-   * It reads messages and dispatches them to appropriate handlers.
+   * @brief Claims a single CAN ID (exact match) for a handler.
+   * Must be called before initialize(), which builds the hardware filters
+   * from the registered set.
+   * @param id The CAN ID to claim.
+   * @param handler Function called with each matching frame.
+   * @param context Passed back to the handler unchanged.
+   * @param extended True for a 29-bit extended ID.
+   * @return True if registered, false if the table is full or the ID is
+   * already claimed.
+   */
+  bool register_rx_handler(uint32_t id, CanRxHandler handler, void *context,
+                           bool extended = false);
+
+  /**
+   * @brief Claims every CAN ID matching an ID/mask pair for a handler.
+   * A received ID matches when (rx_id & mask) == (id & mask).
+   * @param id The base CAN ID.
+   * @param mask Bits of the ID that must match (0x7FF = exact for standard).
+   * @param handler Function called with each matching frame.
+   * @param context Passed back to the handler unchanged.
+   * @param extended True for 29-bit extended IDs.
+   * @return True if registered, false if the table is full or any matching ID
+   * is already claimed.
+   */
+  bool register_rx_handler(uint32_t id, uint32_t mask, CanRxHandler handler,
+                           void *context, bool extended = false);
+
+  /**
+   * @brief Drains every frame queued in the RX ring buffer and dispatches each
+   * one to the appropriate handler.
+   * This should be called frequently in the main loop. Frames are pushed into
+   * the ring by the CAN mailbox interrupt, so nothing is lost between calls as
+   * long as the ring does not overflow.
    */
   void process_incoming_messages();
 
   /**
-   * @brief Sends a CAN frame onto the CAN0 bus.
+   * @brief Number of frames dropped because the RX ring buffer was full.
+   * @return Overflow count since startup (or since reset_rx_stats()).
+   */
+  uint32_t get_rx_overflow_count() const { return rx_overflow_count; }
+
+  /**
+   * @brief Highest number of frames seen waiting in the RX ring buffer.
+   * @return High-water mark since startup (or since reset_rx_stats()).
+   */
+  uint16_t get_rx_high_water() const { return rx_high_water; }
+
+  /**
+   * @brief Resets the RX overflow and high-water counters.
+   */
+  void reset_rx_stats();
+
+  /**
+   * @brief The mailbox filters computed from the registered IDs by the last
+   * initialize(). Each entry reports how many IDs it admits and how many of
+   * those nobody registered for (software-filtered in dispatch_frame()).
+   * @return The current filter plan.
+   */
+  const CanFilterPlan &get_filter_plan() const { return filter_plan; }
+
+  /**
+   * @brief Queues a CAN frame for the CAN0 bus and sends as much of the queue
+   * as the hardware will take right now.
+   * If a frame with the same ID and coalesce key is still waiting in the same
+   * priority class, it is replaced in place (latest value wins, keeps its
+   * place in the queue).
    * @param frame The CAN_FRAME object to send.
-   * @return True if the message was queued for sending, false otherwise.
+   * @param priority Priority class (default: telemetry).
+   * @param coalesce_key Identifies frames that supersede each other, e.g. the
+   * Bamocar register ID. CAN_TX_NO_COALESCE always appends.
+   * @return True if the message was queued (or coalesced), false if that
+   * priority class is full.
+   */
+  bool send_message(const CAN_FRAME &frame,
+                    CanTxPriority priority = CAN_TX_PRIORITY_TELEMETRY,
+                    uint16_t coalesce_key = CAN_TX_NO_COALESCE);
+
+  /**
+   * @brief Moves queued frames into the hardware TX mailbox, highest priority
+   * first, while the mailbox is free. Call every loop pass.
+   */
+  void process_outgoing_messages();
+
+  /**
+   * @brief Frames rejected because their priority class queue was full.
+   */
+  uint32_t get_tx_drop_count() const { return tx_drop_count; }
+
+  /**
+   * @brief Closes the current measurement window every CAN_DIAG_PERIOD_MS,
+   * updating the VCU-visible load estimate and publishing one compact
+   * diagnostic frame (CAN_DIAG_TX_ID) at telemetry priority. Call every loop
+   * pass.
+   *
+   * Diagnostic frame layout (little endian):
+   *   bytes 0-1  VCU-visible load, 0.1 % units (lower bound on bus load)
+   *   bytes 2-3  RX frames in the window
+   *   byte  4    RX ring overflows in the window (saturating)
+   *   byte  5    TX queue drops in the window (saturating)
+   *   byte  6    TX failures in the window (saturating)
+   *   byte  7    RX ring high-water mark
+   */
+  void update_diagnostics();
+
+  /**
+   * @brief Gets the counters for one CAN ID.
+   * @param id The CAN ID.
+   * @param extended True for a 29-bit ID.
+   * @return Pointer to the stats, or nullptr if the ID has not been seen.
+   */
+  const CanIdStats *get_id_stats(uint32_t id, bool extended = false) const;
+
+  /**
+   * @brief Gets the per-ID stats table for iteration (CAN_STATS_MAX_IDS
+   * entries, check in_use).
+   */
+  const CanIdStats *get_id_stats_table() const { return id_stats; }
+
+  /**
+   * @brief Gets the bus-wide counters.
+   * @param stats Filled with a copy of the current counters.
+   */
+  void get_bus_stats(CanBusStats &stats) const;
+
+  /**
+   * @brief Queued frames replaced by a newer frame with the same key.
+   */
+  uint32_t get_tx_coalesced_count() const { return tx_coalesced_count; }
+
+  /**
+   * @brief Times Can0.sendFrame() refused a frame (retried next pass).
+   */
+  uint32_t get_tx_fail_count() const { return tx_fail_count; }
+
+  /**
+   * @brief Passes a single received frame to the handler for its CAN ID,
+   * bypassing the RX ring (replaying captured frames, benchmarks).
+   * Standard IDs resolve through a direct lookup table, so the cost does not
+   * grow with the number of registered IDs.
+   * @param frame The received CAN_FRAME.
+   */
+  void dispatch_frame(const CAN_FRAME &frame);
+
+  /**
+   * @brief Queues a frame exactly as the RX ISR would, to be handled by the
+   * next process_incoming_messages(). Must not be called while the CAN
+   * interrupt can also push (the ring has a single producer); intended for
+   * benchmarks and replaying captured traffic.
+   * @param frame The frame to queue.
    */
-  bool send_message(const CAN_FRAME &frame);
+  void queue_rx_frame(const CAN_FRAME &frame) { push_rx_frame_isr(frame); }
 
 private:
   /**
-   * @brief Configures the hardware filters for specific CAN IDs.
+   * @brief Plans and configures the hardware filters for the registered IDs.
    * This is called internally by initialize().
    * @return True if filters were set successfully, false otherwise.
    */
   bool setup_filters();
 
+  CanFilterPlan filter_plan; // Result of the last setup_filters()
+
+  // One entry per register_rx_handler() call.
+  struct RxRegistration {
+    uint32_t id;
+    uint32_t mask;
+    bool extended;
+    CanRxHandler handler;
+    void *context;
+  };
+  RxRegistration rx_handlers[CAN_MAX_RX_HANDLERS];
+  uint8_t rx_handler_count;
+
+  // Standard ID -> (rx_handlers index + 1), 0 = not claimed. 2 KB of SRAM
+  // buys a single indexed load per frame regardless of how many IDs we add.
+  uint8_t std_id_lookup[CAN_STD_ID_COUNT];
+
+  /**
+   * @brief Copies a frame into the RX ring buffer. Called from the CAN
+   * mailbox interrupt only (single producer).
+   * @param frame The frame read from the mailbox by due_can.
+   */
+  void push_rx_frame_isr(const CAN_FRAME &frame);
+
+  /**
+   * @brief Takes the oldest frame out of the RX ring buffer. Called from the
+   * main loop only (single consumer).
+   * @param frame Destination for the frame.
+   * @param timestamp_us micros() when the ISR queued the frame.
+   * @return True if a frame was available, false if the ring was empty.
+   */
+  bool pop_rx_frame(CAN_FRAME &frame, uint32_t &timestamp_us);
+
+  /**
+   * @brief Finds (or allocates) the stats slot for an ID.
+   * @return The slot, or nullptr if the table is full.
+   */
+  CanIdStats *find_id_stats(uint32_t id, bool extended, bool allocate);
+
+  /**
+   * @brief Updates per-ID and bus counters for a received frame.
+   */
+  void record_rx(const CAN_FRAME &frame, uint32_t timestamp_us);
+
+  /**
+   * @brief Updates per-ID and bus counters for a frame handed to hardware.
+   */
+  void record_tx(const CAN_FRAME &frame);
+
+  /**
+   * @brief Estimated bits on the wire for a frame (incl. stuffing and IFS).
+   * Only applied to frames the VCU sees, see CAN_BUS_BITRATE.
+   */
+  static uint32_t frame_bits(const CAN_FRAME &frame);
+
+  /**
+   * @brief due_can general callback, runs in interrupt context for every
+   * frame accepted by a mailbox filter.
+   * @param frame Pointer to the received frame (owned by due_can).
+   */
+  static void rx_isr_callback(CAN_FRAME *frame);
+
+  // Software TX queue, one FIFO ring per priority class.
+  struct TxEntry {
+    CAN_FRAME frame;
+    uint16_t coalesce_key;
+  };
+  struct TxQueue {
+    TxEntry entries[CAN_TX_QUEUE_DEPTH];
+    uint8_t head;  // Index of the oldest entry
+    uint8_t count; // Entries in use
+  };
+  TxQueue tx_queues[CAN_TX_PRIORITY_COUNT];
+  uint32_t tx_drop_count;
+  uint32_t tx_coalesced_count;
+  uint32_t tx_fail_count;
+
+  // Instrumentation
+  CanIdStats id_stats[CAN_STATS_MAX_IDS];
+  CanBusStats bus_stats;
+  uint32_t window_bits;         // Bits on the wire in the current window
+  uint32_t window_start_ms;     // millis() when the current window started
+  uint32_t window_rx_overflows; // rx_overflow_count at window start
+  uint32_t window_tx_drops;     // tx_drop_count at window start
+  uint32_t window_tx_failures;  // tx_fail_count at window start
+  uint32_t window_rx_frames;
+  uint32_t window_tx_frames;
+
+  // Lock-free single-producer/single-consumer RX ring. The ISR only writes
+  // rx_head, the main loop only writes rx_tail.
+  CAN_FRAME rx_ring[CAN_RX_RING_SIZE];
+  uint32_t rx_ring_time_us[CAN_RX_RING_SIZE]; // micros() at ISR
+  volatile uint16_t rx_head;
+  volatile uint16_t rx_tail;
+  volatile uint32_t rx_overflow_count;
+  volatile uint16_t rx_high_water;
+
   // Add pointers or references to handlers if needed, e.g.:
   // Bamocar* bamocar_handler;
   // BMSHandler* bms_handler;
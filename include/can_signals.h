@@ -0,0 +1,312 @@
+/**
+ * @file can_signals.h
+ * @brief CAN signal decoders GENERATED by tools/dbc_codegen.py from the DBC
+ * files in dbc/. Do not edit: change the DBC and run
+ *   python3 tools/dbc_codegen.py
+ * One struct per message, one constexpr function per signal taking the
+ * frame's data bytes. Bit positions are fixed at generation time, so each
+ * decoder is a handful of loads, shifts and masks. Scaled signals have a
+ * *_raw() integer decoder and a float one with factor and offset applied.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef CAN_SIGNALS_H
+#define CAN_SIGNALS_H
+
+#include <stdint.h>
+
+namespace can_signals {
+
+// Two's complement value of the low BITS bits of raw
+template <uint8_t BITS> constexpr int32_t sign_extend(uint32_t raw) {
+  return (int32_t)(raw << (32 - BITS)) >> (32 - BITS);
+}
+
+// Orion_Pack_1 (0x420, 8 bytes, from BMS, dbc/vcu.dbc). Placeholder layout
+// (bms_handler.cpp history) - replace from the Orion utility's CAN export.
+struct OrionPack1 {
+  static constexpr uint32_t ID = 0x420;
+  static constexpr bool EXTENDED = false;
+  static constexpr uint8_t DLC = 8;
+
+  // PackSOC: 0|8@1+ (0.5,0) [0, 127.5] %
+  static constexpr uint8_t pack_soc_raw(const uint8_t *d) { return d[0]; }
+  static constexpr float pack_soc(const uint8_t *d) {
+    return pack_soc_raw(d) * 0.5f;
+  }
+  static constexpr uint8_t PACK_SOC_MIN_DLC = 1;
+
+  // PackDCL: 8|16@1+ (1,0) [0, 65535] A
+  static constexpr uint16_t pack_dcl(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t PACK_DCL_MIN_DLC = 3;
+
+  // HighTemperature: 16|8@1- (1,0) [-128, 127] degC. Overlaps PackDCL in the
+  // placeholder layout.
+  static constexpr int8_t high_temperature(const uint8_t *d) {
+    return (int8_t)d[2];
+  }
+  static constexpr uint8_t HIGH_TEMPERATURE_MIN_DLC = 3;
+
+  // HighCellVoltage: 32|16@1+ (0.0001,0) [0, 6.5535] V
+  static constexpr uint16_t high_cell_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[4] | (d[5] << 8));
+  }
+  static constexpr float high_cell_voltage(const uint8_t *d) {
+    return high_cell_voltage_raw(d) * 0.0001f;
+  }
+  static constexpr uint8_t HIGH_CELL_VOLTAGE_MIN_DLC = 6;
+
+  // LowCellVoltage: 48|16@1+ (0.0001,0) [0, 6.5535] V
+  static constexpr uint16_t low_cell_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[6] | (d[7] << 8));
+  }
+  static constexpr float low_cell_voltage(const uint8_t *d) {
+    return low_cell_voltage_raw(d) * 0.0001f;
+  }
+  static constexpr uint8_t LOW_CELL_VOLTAGE_MIN_DLC = 8;
+};
+
+// Orion_Pack_2 (0x421, 8 bytes, from BMS, dbc/vcu.dbc). Placeholder layout -
+// replace from the Orion utility's CAN export.
+struct OrionPack2 {
+  static constexpr uint32_t ID = 0x421;
+  static constexpr bool EXTENDED = false;
+  static constexpr uint8_t DLC = 8;
+
+  // PackCCL: 0|16@1+ (1,0) [0, 65535] A
+  static constexpr uint16_t pack_ccl(const uint8_t *d) {
+    return (uint16_t)(d[0] | (d[1] << 8));
+  }
+  static constexpr uint8_t PACK_CCL_MIN_DLC = 2;
+
+  // PackVoltage: 16|16@1+ (0.1,0) [0, 6553.5] V
+  static constexpr uint16_t pack_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[2] | (d[3] << 8));
+  }
+  static constexpr float pack_voltage(const uint8_t *d) {
+    return pack_voltage_raw(d) * 0.1f;
+  }
+  static constexpr uint8_t PACK_VOLTAGE_MIN_DLC = 4;
+
+  // PackCurrent: 32|16@1- (0.1,0) [-3276.8, 3276.7] A. Positive = discharge.
+  static constexpr int16_t pack_current_raw(const uint8_t *d) {
+    return (int16_t)(d[4] | (d[5] << 8));
+  }
+  static constexpr float pack_current(const uint8_t *d) {
+    return pack_current_raw(d) * 0.1f;
+  }
+  static constexpr uint8_t PACK_CURRENT_MIN_DLC = 6;
+
+  // AvgCellVoltage: 48|16@1+ (0.0001,0) [0, 6.5535] V
+  static constexpr uint16_t avg_cell_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[6] | (d[7] << 8));
+  }
+  static constexpr float avg_cell_voltage(const uint8_t *d) {
+    return avg_cell_voltage_raw(d) * 0.0001f;
+  }
+  static constexpr uint8_t AVG_CELL_VOLTAGE_MIN_DLC = 8;
+};
+
+// Orion_Cell_Broadcast (0x36, 8 bytes, from BMS, dbc/vcu.dbc). One cell per
+// frame.
+struct OrionCellBroadcast {
+  static constexpr uint32_t ID = 0x36;
+  static constexpr bool EXTENDED = false;
+  static constexpr uint8_t DLC = 8;
+
+  // CellId: 0|8@1+ (1,0) [0, 255]
+  static constexpr uint8_t cell_id(const uint8_t *d) { return d[0]; }
+  static constexpr uint8_t CELL_ID_MIN_DLC = 1;
+
+  // CellVoltage: 15|16@0+ (0.1,0) [0, 6553.5] mV
+  static constexpr uint16_t cell_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[2] | (d[1] << 8));
+  }
+  static constexpr float cell_voltage(const uint8_t *d) {
+    return cell_voltage_raw(d) * 0.1f;
+  }
+  static constexpr uint8_t CELL_VOLTAGE_MIN_DLC = 3;
+
+  // CellShunting: 31|1@0+ (1,0) [0, 1]
+  static constexpr bool cell_shunting(const uint8_t *d) { return d[3] >> 7; }
+  static constexpr uint8_t CELL_SHUNTING_MIN_DLC = 4;
+
+  // CellResistance: 30|15@0+ (0.01,0) [0, 327.67] mOhm
+  static constexpr uint16_t cell_resistance_raw(const uint8_t *d) {
+    return (uint16_t)(d[4] | ((d[3] & 0x7F) << 8));
+  }
+  static constexpr float cell_resistance(const uint8_t *d) {
+    return cell_resistance_raw(d) * 0.01f;
+  }
+  static constexpr uint8_t CELL_RESISTANCE_MIN_DLC = 5;
+
+  // CellOpenVoltage: 47|16@0+ (0.1,0) [0, 6553.5] mV
+  static constexpr uint16_t cell_open_voltage_raw(const uint8_t *d) {
+    return (uint16_t)(d[6] | (d[5] << 8));
+  }
+  static constexpr float cell_open_voltage(const uint8_t *d) {
+    return cell_open_voltage_raw(d) * 0.1f;
+  }
+  static constexpr uint8_t CELL_OPEN_VOLTAGE_MIN_DLC = 7;
+
+  // Checksum: 56|8@1+ (1,0) [0, 255]. Low byte of ID + DLC + bytes 0-6.
+  static constexpr uint8_t checksum(const uint8_t *d) { return d[7]; }
+  static constexpr uint8_t CHECKSUM_MIN_DLC = 8;
+};
+
+// Orion_Thermistor_Broadcast (0x1838F380 extended, 8 bytes, from TEM,
+// dbc/vcu.dbc). Thermistor expansion module, one thermistor per frame.
+struct OrionThermistorBroadcast {
+  static constexpr uint32_t ID = 0x1838F380;
+  static constexpr bool EXTENDED = true;
+  static constexpr uint8_t DLC = 8;
+
+  // ThermistorId: 7|16@0+ (1,0) [0, 65535]. Across all modules.
+  static constexpr uint16_t thermistor_id(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[0] << 8));
+  }
+  static constexpr uint8_t THERMISTOR_ID_MIN_DLC = 2;
+
+  // ThermistorTemperature: 16|8@1- (1,0) [-128, 127] degC
+  static constexpr int8_t thermistor_temperature(const uint8_t *d) {
+    return (int8_t)d[2];
+  }
+  static constexpr uint8_t THERMISTOR_TEMPERATURE_MIN_DLC = 3;
+
+  // ModuleThermistorId: 24|8@1+ (1,0) [0, 255]
+  static constexpr uint8_t module_thermistor_id(const uint8_t *d) {
+    return d[3];
+  }
+  static constexpr uint8_t MODULE_THERMISTOR_ID_MIN_DLC = 4;
+
+  // ModuleLowestTemperature: 32|8@1- (1,0) [-128, 127] degC
+  static constexpr int8_t module_lowest_temperature(const uint8_t *d) {
+    return (int8_t)d[4];
+  }
+  static constexpr uint8_t MODULE_LOWEST_TEMPERATURE_MIN_DLC = 5;
+
+  // ModuleHighestTemperature: 40|8@1- (1,0) [-128, 127] degC
+  static constexpr int8_t module_highest_temperature(const uint8_t *d) {
+    return (int8_t)d[5];
+  }
+  static constexpr uint8_t MODULE_HIGHEST_TEMPERATURE_MIN_DLC = 6;
+};
+
+// Bamocar_Response (0x181, 8 bytes, from Bamocar, dbc/vcu.dbc). Register
+// response: RegId selects the register, value from byte 1.
+struct BamocarResponse {
+  static constexpr uint32_t ID = 0x181;
+  static constexpr bool EXTENDED = false;
+  static constexpr uint8_t DLC = 8;
+
+  // RegId: 0|8@1+ (1,0) [0, 255]
+  static constexpr uint8_t reg_id(const uint8_t *d) { return d[0]; }
+  static constexpr uint8_t REG_ID_MIN_DLC = 1;
+
+  // Status: 8|32@1+ (1,0) [0, 4294967295] (RegId = 0x40)
+  static constexpr uint32_t status(const uint8_t *d) {
+    return (uint32_t)d[1] | ((uint32_t)d[2] << 8) | ((uint32_t)d[3] << 16) |
+           ((uint32_t)d[4] << 24);
+  }
+  static constexpr uint8_t STATUS_MIN_DLC = 5;
+  static constexpr uint8_t STATUS_MUX = 0x40;
+
+  // Ready: 8|16@1+ (1,0) [0, 65535] (RegId = 0xE2)
+  static constexpr uint16_t ready(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t READY_MIN_DLC = 3;
+  static constexpr uint8_t READY_MUX = 0xE2;
+
+  // NActual: 8|16@1- (1,0) [-32768, 32767] (RegId = 0x30). Relative to NMax
+  // (32767 = NMax).
+  static constexpr int16_t n_actual(const uint8_t *d) {
+    return (int16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t N_ACTUAL_MIN_DLC = 3;
+  static constexpr uint8_t N_ACTUAL_MUX = 0x30;
+
+  // NMax: 8|16@1- (1,0) [-32768, 32767] rpm (RegId = 0xC8)
+  static constexpr int16_t n_max(const uint8_t *d) {
+    return (int16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t N_MAX_MIN_DLC = 3;
+  static constexpr uint8_t N_MAX_MUX = 0xC8;
+
+  // IActual: 8|16@1+ (1,0) [0, 65535] (RegId = 0x20)
+  static constexpr uint16_t i_actual(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t I_ACTUAL_MIN_DLC = 3;
+  static constexpr uint8_t I_ACTUAL_MUX = 0x20;
+
+  // IDevice: 8|16@1+ (1,0) [0, 65535] A (RegId = 0xC6)
+  static constexpr uint16_t i_device(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t I_DEVICE_MIN_DLC = 3;
+  static constexpr uint8_t I_DEVICE_MUX = 0xC6;
+
+  // I200pc: 8|16@1+ (1,0) [0, 65535] (RegId = 0xD9)
+  static constexpr uint16_t i200pc(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t I200PC_MIN_DLC = 3;
+  static constexpr uint8_t I200PC_MUX = 0xD9;
+
+  // Torque: 8|16@1- (1,0) [-32768, 32767] (RegId = 0x90)
+  static constexpr int16_t torque(const uint8_t *d) {
+    return (int16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t TORQUE_MIN_DLC = 3;
+  static constexpr uint8_t TORQUE_MUX = 0x90;
+
+  // RampAcc: 8|16@1+ (1,0) [0, 65535] (RegId = 0x35)
+  static constexpr uint16_t ramp_acc(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t RAMP_ACC_MIN_DLC = 3;
+  static constexpr uint8_t RAMP_ACC_MUX = 0x35;
+
+  // RampDec: 8|16@1+ (1,0) [0, 65535] (RegId = 0xED)
+  static constexpr uint16_t ramp_dec(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t RAMP_DEC_MIN_DLC = 3;
+  static constexpr uint8_t RAMP_DEC_MUX = 0xED;
+
+  // TempMotor: 8|16@1+ (1,0) [0, 65535] (RegId = 0x49). Raw sensor counts.
+  static constexpr uint16_t temp_motor(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t TEMP_MOTOR_MIN_DLC = 3;
+  static constexpr uint8_t TEMP_MOTOR_MUX = 0x49;
+
+  // TempIgbt: 8|16@1+ (1,0) [0, 65535] (RegId = 0x4A)
+  static constexpr uint16_t temp_igbt(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t TEMP_IGBT_MIN_DLC = 3;
+  static constexpr uint8_t TEMP_IGBT_MUX = 0x4A;
+
+  // TempAir: 8|16@1+ (1,0) [0, 65535] (RegId = 0x4B)
+  static constexpr uint16_t temp_air(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t TEMP_AIR_MIN_DLC = 3;
+  static constexpr uint8_t TEMP_AIR_MUX = 0x4B;
+
+  // HardEnabled: 8|16@1+ (1,0) [0, 65535] (RegId = 0xE8)
+  static constexpr uint16_t hard_enabled(const uint8_t *d) {
+    return (uint16_t)(d[1] | (d[2] << 8));
+  }
+  static constexpr uint8_t HARD_ENABLED_MIN_DLC = 3;
+  static constexpr uint8_t HARD_ENABLED_MUX = 0xE8;
+};
+
+} // namespace can_signals
+
+#endif // CAN_SIGNALS_H
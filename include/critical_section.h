@@ -0,0 +1,59 @@
+/**
+ * @file critical_section.h
+ * @brief Interrupt masking helpers for state shared between the background
+ * loop and interrupt handlers (e.g. the VCU_TORQUE_ISR torque tick).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef CRITICAL_SECTION_H
+#define CRITICAL_SECTION_H
+
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_SAM)
+#include <Arduino.h> // Pulls in CMSIS (__get_PRIMASK, __disable_irq)
+#endif
+
+/**
+ * @brief Masks all interrupts for the lifetime of the object and restores the
+ * previous mask on exit, so sections nest and are safe inside handlers. Keep
+ * them to a few microseconds: CAN RX and ADC interrupts wait meanwhile.
+ * No-op on the host.
+ */
+class CriticalSection {
+public:
+#if defined(ARDUINO_ARCH_SAM)
+  CriticalSection() : primask(__get_PRIMASK()) { __disable_irq(); }
+  ~CriticalSection() { __set_PRIMASK(primask); }
+
+private:
+  uint32_t primask;
+#else
+  CriticalSection() {}
+#endif
+
+  CriticalSection(const CriticalSection &) = delete;
+  CriticalSection &operator=(const CriticalSection &) = delete;
+};
+
+/**
+ * @brief Stops the compiler moving memory accesses across this point. On the
+ * single-core M3 an interrupt sees stores in program order, so this is all a
+ * lock-free handoff between the loop and a handler needs (no DMB).
+ */
+inline void compiler_barrier() { __asm__ __volatile__("" ::: "memory"); }
+
+/**
+ * @brief True while executing an interrupt handler. Serial must not be used
+ * there: a full TX buffer would block the handler.
+ */
+inline bool in_interrupt_context() {
+#if defined(ARDUINO_ARCH_SAM)
+  return __get_IPSR() != 0;
+#else
+  return false;
+#endif
+}
+
+#endif // CRITICAL_SECTION_H
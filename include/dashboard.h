@@ -0,0 +1,60 @@
+/**
+ * @file dashboard.h
+ * @brief Nextion dashboard renderer. Each text field keeps the last string
+ * sent to the display and is only re-sent when its value has changed, at
+ * most once per field interval. Commands are raw Nextion instructions
+ * (`t1.txt="123"` + 0xFF 0xFF 0xFF) handed to the Serial1 TX buffer only when
+ * the whole command fits, so dash_loop() never waits on the UART; a field
+ * that does not fit stays pending and goes out on a later pass.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Store the fast rate in the display once (`bauds=115200` from the Nextion
+//   editor's debug console) so a display power cycle on its own keeps it.
+// - Replace the heartbeat / placeholder fields once the HMI pages are final.
+
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <stdint.h>
+
+// Serial1 rate after dash_setup(). The display starts at its stored rate
+// (9600 from the factory) and is switched over by dash_setup().
+#ifndef DASH_BAUD_RATE
+#define DASH_BAUD_RATE 115200
+#endif
+#define DASH_BOOT_BAUD_RATE 9600
+
+#define DASH_TEXT_MAX 24 // Longest field text, including the terminator
+
+// Since dash_setup()
+typedef struct {
+  uint32_t commands_sent; // Field updates handed to the UART
+  uint32_t bytes_sent;
+  uint32_t unchanged;     // Field due, but the text matched the last one sent
+  uint32_t deferred;      // Field changed, but the UART buffer had no room
+} DashStats;
+
+/**
+ * @brief Switches the display (and Serial1) to DASH_BAUD_RATE and turns off
+ * command replies. Blocks for a few ms; call from setup() only.
+ */
+void dash_setup();
+
+/**
+ * @brief Formats every field whose interval has elapsed and queues the ones
+ * that changed. Never blocks. Run from the dashboard task.
+ */
+void dash_loop();
+
+/**
+ * @brief Forgets what the display shows, so every field is re-sent (e.g.
+ * after the display has been reset on its own).
+ */
+void dash_invalidate();
+
+const DashStats &dash_get_stats();
+
+#endif // DASHBOARD_H
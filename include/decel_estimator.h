@@ -0,0 +1,95 @@
+/**
+ * @file decel_estimator.h
+ * @brief Vehicle deceleration estimate for the brake light (Rule T6.3.1) and
+ * the regen controller. Two channels, each through an integer Butterworth
+ * biquad updated once per sample: the forward MPU6050 accelerometer axis and
+ * the derivative of the Bamocar motor speed. The channels are blended when
+ * both are fresh, and the result is published with a hysteresis flag, so a
+ * reader only loads one word.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Confirm DECEL_ACCEL_AXIS / DECEL_ACCEL_SIGN against the MPU6050 mounting.
+// - Replace DECEL_WHEEL_RADIUS_MM / DECEL_GEAR_RATIO_X100 with the car's
+//   numbers, then check both channels agree on a straight-line brake test.
+// - Remove the accelerometer's gravity offset on slopes (tilt) if the light
+//   flickers on hills.
+
+#ifndef DECEL_ESTIMATOR_H
+#define DECEL_ESTIMATOR_H
+
+#include "fixed_point.h"
+#include <stdint.h>
+
+// Both channels are stepped by the decel task at this rate (main.cpp)
+#define DECEL_SAMPLE_RATE_HZ 200
+
+// Brake light on above / off below this deceleration (Rule T6.3.1: 1.0 m/s^2
+// with 0.3 m/s^2 tolerance)
+#define DECEL_ON_THRESHOLD_MM_S2 1000
+#define DECEL_OFF_THRESHOLD_MM_S2 700
+
+// Accelerometer axis pointing forward, and the sign that turns it into
+// deceleration (negative X = slowing down)
+#define DECEL_ACCEL_AXIS 0
+#define DECEL_ACCEL_SIGN (-1)
+
+// Motor RPM -> vehicle speed: v = rpm * 2 * PI * r / (60 * gear ratio)
+#define DECEL_WHEEL_RADIUS_MM 228  // 18" tyre - Calibrate!
+#define DECEL_GEAR_RATIO_X100 400  // Motor : wheel - Calibrate!
+
+// Speed channel is dropped if no new N_ACTUAL arrived for this long
+#define DECEL_SPEED_MAX_AGE_US 50000
+
+// Bamocar N_ACTUAL transmit interval requested for the speed channel (ms)
+#define DECEL_SPEED_INTERVAL_MS 10
+
+// Weight of the accelerometer channel when both are fresh (rest: speed)
+#define DECEL_ACCEL_WEIGHT_Q15 Q15_FROM_FLOAT(0.5)
+
+// Channels that went into the estimate (DecelEstimate::sources)
+#define DECEL_SOURCE_ACCEL 0x01
+#define DECEL_SOURCE_SPEED 0x02
+
+typedef struct {
+  int32_t decel_mm_s2;       // Blended estimate (> 0 = slowing down)
+  int32_t accel_decel_mm_s2; // Accelerometer channel, filtered
+  int32_t speed_decel_mm_s2; // Motor speed derivative, filtered
+  uint8_t sources;           // DECEL_SOURCE_* used (0 = no data, decel 0)
+  bool braking;              // decel above the on/off hysteresis band
+  uint32_t timestamp_us;     // micros() of the update
+} DecelEstimate;
+
+/**
+ * @brief Clears both filters. Call from setup().
+ */
+void decel_estimator_begin();
+
+/**
+ * @brief Steps both channels by one sample: the newest MPU sample (if it
+ * changed) and the motor speed, then publishes the blend. Run from the decel
+ * task at DECEL_SAMPLE_RATE_HZ.
+ */
+void decel_estimator_update();
+
+/**
+ * @brief Latest blended deceleration in mm/s^2 (> 0 = slowing down). One
+ * load; safe from any context, including the torque interrupt.
+ */
+int32_t decel_estimator_get_mm_s2();
+
+/**
+ * @brief True while the deceleration is above DECEL_ON_THRESHOLD_MM_S2 and
+ * until it drops below DECEL_OFF_THRESHOLD_MM_S2. One load.
+ */
+bool decel_estimator_is_braking();
+
+/**
+ * @brief Copies the full latest estimate (both channels, for logs).
+ * Background tasks only: the copy is not atomic.
+ */
+void decel_estimator_read(DecelEstimate &estimate);
+
+#endif // DECEL_ESTIMATOR_H
@@ -0,0 +1,120 @@
+/**
+ * @file fault_manager.h
+ * @brief Defines the FaultManager class, the one place that knows which
+ * faults are active. Checks report a condition with set(); the manager keeps
+ * active and latched bitsets, first/last timestamps per fault and a fixed
+ * ring of the most recent transitions, so the order of events behind a
+ * torque cut can be dumped after a run. Torque gating is a single mask test.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Decide which faults must stay latched until an LVMS cycle (FSUK rules)
+//   and gate torque on latched() & that mask for them.
+// - Add an inverter fault from bamocar.getStatus() once the STATUS bits are
+//   confirmed against the Unitek manual.
+
+#ifndef FAULT_MANAGER_H
+#define FAULT_MANAGER_H
+
+#include <stdint.h>
+
+#define FAULT_HISTORY_SIZE 32 // Transitions kept (power of 2)
+
+enum FaultId {
+  FAULT_APPS_IMPLAUSIBLE = 0, // APPS sensors disagree / out of range (EV.5.6)
+  FAULT_APPS_BRAKE,           // APPS > 25 % with brakes on (EV.2.3)
+  FAULT_BMS_CRITICAL,         // BMSHandler::has_critical_fault()
+  FAULT_BMS_COMM_LOST,        // No BMS frame for BMS_COMM_TIMEOUT_MS
+  FAULT_IMD,                  // IMD_FAULT_PIN (monitor_errors.h)
+  FAULT_BSPD,                 // BSPD_FAULT_PIN (monitor_errors.h)
+  FAULT_COUNT
+};
+
+typedef uint16_t FaultMask;
+#define FAULT_BIT(id) ((FaultMask)(1u << (id)))
+
+// Faults that force zero torque while active
+#define FAULT_TORQUE_MASK                                                      \
+  (FAULT_BIT(FAULT_APPS_IMPLAUSIBLE) | FAULT_BIT(FAULT_APPS_BRAKE) |           \
+   FAULT_BIT(FAULT_BMS_CRITICAL) | FAULT_BIT(FAULT_BMS_COMM_LOST) |            \
+   FAULT_BIT(FAULT_IMD) | FAULT_BIT(FAULT_BSPD))
+
+// Per-fault history since start-up (millis())
+typedef struct {
+  uint32_t set_count;     // Times the fault became active
+  uint32_t first_set_ms;  // First activation
+  uint32_t last_set_ms;   // Start of the latest (or current) activation
+  uint32_t last_clear_ms; // End of the latest activation
+} FaultRecord;
+
+// One entry of the transition ring
+typedef struct {
+  uint32_t timestamp_us; // micros() at the transition
+  uint8_t fault;         // FaultId
+  bool active;           // True = became active, false = cleared
+  FaultMask active_mask; // Active set right after the transition
+} FaultTransition;
+
+class FaultManager {
+public:
+  FaultManager();
+
+  /**
+   * @brief Reports the current condition of one fault. Does nothing unless
+   * the state changes; a change updates the bitsets and record, appends to
+   * the transition ring and logs it. Safe from the torque interrupt.
+   * @param id Fault to update.
+   * @param active True while the fault condition holds.
+   * @return True if the state changed.
+   */
+  bool set(FaultId id, bool active);
+
+  bool is_active(FaultId id) const { return (active & FAULT_BIT(id)) != 0; }
+
+  /**
+   * @brief True if any torque-gating fault is active: one load and one AND.
+   */
+  bool torque_inhibited() const { return (active & FAULT_TORQUE_MASK) != 0; }
+
+  FaultMask get_active() const { return active; }
+
+  /**
+   * @brief Every fault that has been active since start-up or the last
+   * clear_latched(), including ones that have cleared again.
+   */
+  FaultMask get_latched() const { return latched; }
+
+  /**
+   * @brief Resets the latched set to the currently active faults.
+   */
+  void clear_latched();
+
+  const FaultRecord &get_record(FaultId id) const { return records[id]; }
+
+  /**
+   * @brief Transitions recorded since start-up (the ring keeps the last
+   * FAULT_HISTORY_SIZE).
+   */
+  uint32_t get_transition_count() const { return transition_count; }
+
+  /**
+   * @brief Prints the bitsets, every fault's record and the transition ring,
+   * oldest first, to Serial. Background only.
+   */
+  void print_history() const;
+
+  static const char *get_name(FaultId id);
+
+private:
+  volatile FaultMask active;
+  volatile FaultMask latched;
+  FaultRecord records[FAULT_COUNT];
+  FaultTransition history[FAULT_HISTORY_SIZE];
+  uint32_t transition_count; // Next history slot = count % size
+};
+
+extern FaultManager fault_manager;
+
+#endif // FAULT_MANAGER_H
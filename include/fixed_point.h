@@ -0,0 +1,62 @@
+/**
+ * @file fixed_point.h
+ * @brief Q15 fixed-point helpers for the torque pipeline. The SAM3X8E
+ * (Cortex-M3) has no FPU, so float/double math is software-emulated; the
+ * control path uses these instead. Q15: int16_t, 1.0 = 32768 (max 32767).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+typedef int16_t q15_t; // Fraction in [-1.0, 1.0), 1 LSB = 1/32768
+typedef int32_t q31_t; // Fraction in [-1.0, 1.0), 1 LSB = 2^-31
+
+#define Q15_ONE 32767 // Largest Q15 value (~1.0)
+#define Q15_MIN (-32768)
+
+// Compile-time conversion of a constant fraction to Q15 (rounded, saturated).
+// Only use with constant expressions; it is floating point.
+#define Q15_FROM_FLOAT(x)                                                      \
+  ((q15_t)((x) >= (32767.0 / 32768.0)                                          \
+               ? Q15_ONE                                                       \
+               : ((x) <= -1.0 ? Q15_MIN                                        \
+                              : (int32_t)((x)*32768.0 +                        \
+                                          ((x) >= 0 ? 0.5 : -0.5)))))
+
+/**
+ * @brief Saturates a 32-bit intermediate to the Q15 range.
+ */
+inline q15_t q15_saturate(int32_t value) {
+  if (value > Q15_ONE)
+    return Q15_ONE;
+  if (value < Q15_MIN)
+    return Q15_MIN;
+  return (q15_t)value;
+}
+
+/**
+ * @brief Clamps a Q15 value to [low, high].
+ */
+inline q15_t q15_clamp(q15_t value, q15_t low, q15_t high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+/**
+ * @brief Q15 x Q15 -> Q15 multiply (truncating).
+ */
+inline q15_t q15_mul(q15_t a, q15_t b) {
+  return q15_saturate(((int32_t)a * b) >> 15);
+}
+
+/**
+ * @brief Q15 fraction -> tenths of a percent (for logs/prints).
+ */
+inline int16_t q15_to_permille(q15_t value) {
+  return (int16_t)(((int32_t)value * 1000) / 32768);
+}
+
+#endif // FIXED_POINT_H
@@ -16,8 +16,8 @@
 extern int brakePressure; // Raw ADC value from brake pressure sensor
 
 // Removed extern float cellVoltage; -> Now accessed via
-// bms_handler.get_bms_data().low_cell_voltage etc. Removed extern int
-// stateOfCharge; -> Now accessed via bms_handler.get_bms_data().pack_soc
+// bms_handler.read_snapshot() (.low_cell_voltage etc.). Removed extern int
+// stateOfCharge; -> Now accessed via the same snapshot (.pack_soc)
 
 // Add other necessary global variables here
 
@@ -14,8 +14,6 @@
 // activation;
 //   consider using deceleration directly from MPU if required by rules
 //   (T6.3.1).
-// - Define pins and logic for monitoring critical errors (IMD, BSPD etc.) via
-// digital inputs.
 
 #ifndef HEADER_H
 #define HEADER_H
@@ -33,19 +31,39 @@
 // ------------ EXTERNAL LIBRARIES ------------
 #include <Adafruit_MPU6050.h> // For MPU6050 sensor
 #include <Adafruit_Sensor.h>  // Required by Adafruit MPU6050 library
-#include <Nextion.h>          // For Nextion display (if used)
 #include <due_can.h>          // CAN library for Arduino Due
 
 // ------------ PROJECT MODULES ------------
-#include "apps.h"        // APPS reading constants/functions
-#include "bamocar-due.h" // Bamocar motor controller library
-#include "bms_handler.h" // BMS data handler
-#include "can_manager.h" // CAN bus manager
-#include "globals.h"     // Global variable declarations
+#include "adc_sampler.h"      // DMA sampling of APPS / brake pressure
+#include "apps.h"             // APPS reading constants/functions
+#include "bamocar-due.h"      // Bamocar motor controller library
+#include "bms_handler.h"      // BMS data handler
+#include "can_manager.h"      // CAN bus manager
+#include "critical_section.h" // IRQ masking shared with the torque ISR
+#include "dashboard.h"        // Nextion dashboard renderer
+#include "decel_estimator.h"  // Filtered deceleration (brake light, regen)
+#include "fault_manager.h"    // Fault bitsets, torque gating, history
+#include "fixed_point.h"      // Q15 helpers for the torque pipeline
+#include "globals.h"          // Global variable declarations
+#include "monitor_errors.h"   // Error input fault word (pins 22-37)
+#include "mpu_sampler.h"      // Non-blocking MPU6050 accelerometer
+#include "torque_map.h"       // Pedal x speed torque maps per profile
 
 // ------------ CONSTANTS ------------
 // --- General ---
-const int DEBUG_MODE = 1; // 0=Off, 1=On: Enables Serial print messages
+// 0=Off, 1=On: Enables Serial print messages (set per build with
+// -DVCU_DEBUG_MODE; hot-path messages use the logger levels instead)
+#ifndef VCU_DEBUG_MODE
+#define VCU_DEBUG_MODE 1
+#endif
+const int DEBUG_MODE = VCU_DEBUG_MODE;
+
+// True if messages at this DEBUG_MODE level may be printed here. Code that can
+// run in the torque interrupt (VCU_TORQUE_ISR) uses this instead of testing
+// DEBUG_MODE directly: Serial can block, which an interrupt must never do.
+inline bool debug_enabled(int level = 1) {
+  return DEBUG_MODE >= level && !in_interrupt_context();
+}
 
 // --- Pins ---
 // Analog Pins
@@ -54,26 +72,31 @@ const int APPS_1_PIN = A6;
 const int APPS_2_PIN = A7;
 // Digital Pins
 const int BRAKE_LIGHT_PIN = 7;
-// TODO: Define pins used for monitoring critical errors (IMD, BSPD, etc.)
-const int ERROR_PIN_START = 22; // Example start pin for error monitoring
-const int ERROR_PIN_END = 37;   // Example end pin for error monitoring
-// const int IMD_FAULT_PIN = 22; // Example specific pin
-// const int BSPD_FAULT_PIN = 23; // Example specific pin
+// Error monitoring inputs (IMD_FAULT_PIN, BSPD_FAULT_PIN: monitor_errors.h)
+const int ERROR_PIN_START = ERROR_INPUT_FIRST_PIN;
+const int ERROR_PIN_END = ERROR_INPUT_FIRST_PIN + ERROR_INPUT_COUNT - 1;
 
 // --- Thresholds & Parameters ---
 // Brake System
 // TODO: Calibrate these thresholds based on sensor readings
-const int BRAKE_LIGHT_THRESHOLD = 500; // Raw ADC value - Calibrate!
-const int BRAKE_LIGHT_HYSTERESIS = 15; // Raw ADC value - Calibrate!
+const int BRAKE_LIGHT_THRESHOLD =
+    32000; // Filtered ADC value, 16-bit scale (adc_sampler) - Calibrate!
+const int BRAKE_LIGHT_HYSTERESIS =
+    960; // Filtered ADC value, 16-bit scale (adc_sampler) - Calibrate!
 // TODO: Verify necessity/logic/value for tilt activation
 const float TILT_THRESHOLD_DEG = 5.8; // For MPU6050 brake light activation -
                                       // Verify necessity/logic (Rule T6.3.1)
 const int APPS_BRAKE_PLAUSIBILITY_THRESHOLD =
     25; // % APPS request threshold for brake plausibility check (Rule EV.5.7)
+const q15_t APPS_BRAKE_PLAUSIBILITY_THRESHOLD_Q15 =
+    Q15_FROM_FLOAT(APPS_BRAKE_PLAUSIBILITY_THRESHOLD / 100.0);
 
 // APPS
-const float APPS_PLAUSIBILITY_THRESHOLD =
+constexpr float APPS_PLAUSIBILITY_THRESHOLD =
     10.0f; // % difference threshold (Rule EV.5.6)
+// Truncated, so `diff > threshold` flips at the same point as the float check
+const q15_t APPS_PLAUSIBILITY_THRESHOLD_Q15 =
+    (q15_t)(APPS_PLAUSIBILITY_THRESHOLD * 32768.0 / 100.0);
 
 // Timing
 const unsigned long APPS_PLAUSIBILITY_TIMEOUT_MS =
@@ -99,19 +122,25 @@ extern Adafruit_MPU6050 mpu; // If MPU6050 is used globally
 // --- Sensor/Input Modules ---
 double
 get_apps_reading(); // Returns pedal position (%) or -1.0 on implausibility
-void brake_light(); // Reads brake pressure, MPU, controls brake light
+q15_t get_apps_reading_q15(); // Integer path: pedal fraction (Q15) or -1
+q15_t get_apps_reading_q15(const AdcSnapshot &adc); // Same, for a given scan
+void brake_light(); // Reads brake pressure, MPU sample, controls brake light
 
 // --- Actuator/Control Modules ---
 void motor_control_update(); // New function to handle motor control logic
                              // including safety checks
+q15_t regen_torque_limit_q15(int32_t power_w, int32_t speed_rpm,
+                             int32_t max_torque_nm); // Regen cap (Q15 > 0)
+void motor_control_begin(); // Builds the regen envelope table (setup)
+q15_t regen_envelope_q15(int32_t power_w,
+                         int32_t speed_rpm); // Cached, conservative cap
+void motor_control_request_feedback(); // Periodic Bamocar status requests
 // void send_torque_request(double torqueRequest); // Integrated into
 // motor_control_update
 
 // --- Monitoring/Dashboard Modules ---
-void monitor_errors_setup(); // Renamed from monitor_pins_setup
-void monitor_errors_loop();  // Renamed from monitor_pins_loop
-void dash_setup();           // Setup for Nextion display (if used)
-void dash_loop();            // Update loop for Nextion display (if used)
+// monitor_errors_setup() / monitor_errors_loop(): see monitor_errors.h
+// dash_setup() / dash_loop(): see dashboard.h
 
 // --- Utility Functions ---
 // Add any other helper function prototypes here
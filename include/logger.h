@@ -0,0 +1,148 @@
+/**
+ * @file logger.h
+ * @brief Non-blocking binary event logger. A call stores a compact record
+ * (event ID, micros() timestamp, up to four int32 arguments) in a RAM ring
+ * and returns; no formatting, no Serial, safe from interrupts. A background
+ * task (logger_drain()) moves whole records to Serial as fast as the UART
+ * buffer accepts them, and tools/log_decode.py turns them back into text.
+ * When the ring is full new records are dropped and counted, never waited
+ * for. Which events exist at all is decided at build time: see
+ * VCU_LOG_LEVEL and VCU_LOG_CATEGORIES below.
+ *
+ * Wire format, little endian, 8 + 4 * argc bytes:
+ *   0xA5 | id | argc | timestamp_us (4) | args (4 each) | XOR of id..args
+ * Plain text printed on the same port passes through the decoder unchanged.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Check logger_get_dropped_count() after a run of the due_verbose build and
+//   grow LOGGER_BUFFER_SIZE (or the baud rate) if records are lost.
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+
+// Ring size in bytes (power of 2)
+#ifndef LOGGER_BUFFER_SIZE
+#define LOGGER_BUFFER_SIZE 2048
+#endif
+
+#define LOGGER_SYNC_BYTE 0xA5
+#define LOG_MAX_ARGS 4
+#define LOG_RECORD_HEADER_BYTES 7 // Sync, id, argc, timestamp
+#define LOG_RECORD_MAX_BYTES (LOG_RECORD_HEADER_BYTES + 4 * LOG_MAX_ARGS + 1)
+
+//------------------------------------------------------------------------------
+// Build-Time Filtering (override with -D in platformio.ini build_flags)
+//------------------------------------------------------------------------------
+// Levels: an event is kept if its level <= VCU_LOG_LEVEL (0 = no logging)
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Categories: an event is kept if its bit is set in VCU_LOG_CATEGORIES
+#define LOG_CAT_SYSTEM (1u << 0)
+#define LOG_CAT_CAN (1u << 1)
+#define LOG_CAT_BMS (1u << 2)
+#define LOG_CAT_APPS (1u << 3)
+#define LOG_CAT_MOTOR (1u << 4)
+#define LOG_CAT_BRAKE (1u << 5)
+#define LOG_CAT_FAULT (1u << 6)
+#define LOG_CAT_ALL 0xFFu
+
+#ifndef VCU_LOG_LEVEL
+#define VCU_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef VCU_LOG_CATEGORIES
+#define VCU_LOG_CATEGORIES LOG_CAT_ALL
+#endif
+
+// Event IDs, in log_events.def order. Filtered-out events keep their ID, so
+// the decoder works with any build.
+typedef enum {
+#define LOG_EVENT(name, category, level, format) LOG_##name,
+#include "log_events.def"
+#undef LOG_EVENT
+  LOG_EVENT_COUNT
+} LogEventId;
+
+/**
+ * @brief Appends one record to the ring. Takes well under a microsecond and
+ * never blocks; if the ring is full the record is dropped and counted. Use
+ * log_event<>() instead, which applies the build-time filter.
+ * @param id Event from log_events.def.
+ * @param args Arguments (may be nullptr when count is 0).
+ * @param count Number of arguments, at most LOG_MAX_ARGS.
+ */
+void logger_write(LogEventId id, const int32_t *args, uint8_t count);
+
+namespace logger_detail {
+constexpr uint8_t event_levels[] = {
+#define LOG_EVENT(name, category, level, format) LOG_LEVEL_##level,
+#include "log_events.def"
+#undef LOG_EVENT
+};
+
+constexpr uint8_t event_categories[] = {
+#define LOG_EVENT(name, category, level, format) LOG_CAT_##category,
+#include "log_events.def"
+#undef LOG_EVENT
+};
+
+// Selected at compile time: disabled events get the empty emit()
+template <bool enabled> struct Dispatch {
+  template <typename... Args>
+  static inline void emit(LogEventId id, Args... args) {
+    const int32_t values[] = {(int32_t)args..., 0}; // Never zero-sized
+    logger_write(id, values, sizeof...(Args));
+  }
+};
+
+template <> struct Dispatch<false> {
+  template <typename... Args> static inline void emit(LogEventId, Args...) {}
+};
+} // namespace logger_detail
+
+/**
+ * @brief True if the event survives VCU_LOG_LEVEL / VCU_LOG_CATEGORIES.
+ */
+constexpr bool log_event_enabled(LogEventId id) {
+  return logger_detail::event_levels[id] <= VCU_LOG_LEVEL &&
+         (logger_detail::event_categories[id] & VCU_LOG_CATEGORIES) != 0;
+}
+
+/**
+ * @brief Logs an event, e.g. log_event<LOG_BMS_BAD_DLC>(frame.id, length).
+ * Events filtered out at build time compile to nothing: no call, no branch,
+ * no data. Arguments are converted to int32.
+ */
+template <LogEventId id, typename... Args>
+inline void log_event(Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+  logger_detail::Dispatch<log_event_enabled(id)>::emit(id, args...);
+}
+
+/**
+ * @brief Moves whole records from the ring to Serial while the UART has room
+ * for them (Serial.availableForWrite()), then returns. Background only. The
+ * host build prints the formatted text instead of the binary records.
+ */
+void logger_drain();
+
+/**
+ * @brief Records lost because the ring was full, since start-up.
+ */
+uint32_t logger_get_dropped_count();
+
+/**
+ * @brief Highest ring fill level seen, in bytes.
+ */
+uint32_t logger_get_high_water();
+
+#endif // LOGGER_H
@@ -0,0 +1,111 @@
+/**
+ * @file min_max_tree.h
+ * @brief Fixed-size array with incrementally maintained minimum, maximum and
+ * sum. Two tournament trees of element indices sit over the array, so
+ * changing one element costs one sum update and log2(N) comparisons per
+ * tree instead of a rescan; the extremes (and which element holds them) are
+ * then single loads. Elements start out unreported and never win until
+ * their first update(). All storage is inside the object.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef MIN_MAX_TREE_H
+#define MIN_MAX_TREE_H
+
+#include <stdint.h>
+#include <string.h> // For memset
+
+#define MIN_MAX_TREE_NONE 0xFF // Index when no element has been reported
+
+template <typename T, uint16_t N> class MinMaxTree {
+public:
+  MinMaxTree() { clear(); }
+
+  /**
+   * @brief Marks every element unreported (count() = 0).
+   */
+  void clear() {
+    memset(values, 0, sizeof(values));
+    memset(reported_bits, 0, sizeof(reported_bits));
+    memset(min_tree, MIN_MAX_TREE_NONE, sizeof(min_tree));
+    memset(max_tree, MIN_MAX_TREE_NONE, sizeof(max_tree));
+    total = 0;
+    reported = 0;
+  }
+
+  /**
+   * @brief Sets one element and walks both trees from its leaf to the root.
+   * @param index Element (< N; larger indices are ignored).
+   * @param value New value.
+   */
+  void update(uint16_t index, T value) {
+    if (index >= N)
+      return;
+    uint8_t bit = (uint8_t)(1u << (index & 7));
+    if (reported_bits[index >> 3] & bit) {
+      total -= values[index];
+    } else {
+      reported_bits[index >> 3] |= bit;
+      reported++;
+    }
+    values[index] = value;
+    total += value;
+
+    uint16_t node = LEAVES + index;
+    min_tree[node] = max_tree[node] = (uint8_t)index;
+    for (node >>= 1; node != 0; node >>= 1) {
+      min_tree[node] = pick(min_tree[2 * node], min_tree[2 * node + 1], true);
+      max_tree[node] = pick(max_tree[2 * node], max_tree[2 * node + 1], false);
+    }
+  }
+
+  T get(uint16_t index) const { return values[index]; }
+  bool is_reported(uint16_t index) const {
+    return (reported_bits[index >> 3] >> (index & 7)) & 1u;
+  }
+
+  uint16_t count() const { return reported; } // Elements reported so far
+  int32_t sum() const { return total; }       // Over reported elements
+
+  // Extremes and their indices (MIN_MAX_TREE_NONE / 0 while count() == 0)
+  uint8_t min_index() const { return min_tree[1]; }
+  uint8_t max_index() const { return max_tree[1]; }
+  T min() const { return reported ? values[min_tree[1]] : 0; }
+  T max() const { return reported ? values[max_tree[1]] : 0; }
+
+  /**
+   * @brief Mean of the reported elements, truncated (one divide).
+   */
+  T average() const { return reported ? (T)(total / (int32_t)reported) : 0; }
+
+private:
+  static_assert(N > 0 && N < MIN_MAX_TREE_NONE,
+                "Indices are stored as uint8_t");
+
+  // Leaves: N rounded up to a power of 2 (node 1 is the root)
+  static constexpr uint16_t leaves_for(uint16_t n, uint16_t p = 1) {
+    return p >= n ? p : leaves_for(n, (uint16_t)(p * 2));
+  }
+  static constexpr uint16_t LEAVES = leaves_for(N);
+
+  // Winner of two children; an unreported side always loses
+  uint8_t pick(uint8_t a, uint8_t b, bool want_min) const {
+    if (a == MIN_MAX_TREE_NONE)
+      return b;
+    if (b == MIN_MAX_TREE_NONE)
+      return a;
+    if (want_min)
+      return values[b] < values[a] ? b : a;
+    return values[b] > values[a] ? b : a;
+  }
+
+  T values[N];
+  uint8_t reported_bits[(N + 7) / 8];
+  uint8_t min_tree[2 * LEAVES];
+  uint8_t max_tree[2 * LEAVES];
+  int32_t total;
+  uint16_t reported;
+};
+
+#endif // MIN_MAX_TREE_H
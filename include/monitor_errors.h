@@ -0,0 +1,71 @@
+/**
+ * @file monitor_errors.h
+ * @brief Error input monitor. The 16 error lines (pins 22-37) are sampled
+ * into one fault word, bit n = pin ERROR_INPUT_FIRST_PIN + n, set while the
+ * line is HIGH. On the Due the word comes straight from the PIO PDSR
+ * registers in one pass instead of 16 digitalRead() calls. The critical
+ * lines (IMD, BSPD) also have a pin-change interrupt that refreshes the word
+ * the moment they move, so the next control tick sees a fault without
+ * waiting for the error_monitor task.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Confirm which signal is wired to which of pins 22-37 (and that HIGH
+//   means fault on each) and extend ERROR_CRITICAL_MASK to match.
+
+#ifndef MONITOR_ERRORS_H
+#define MONITOR_ERRORS_H
+
+#include <stdint.h>
+
+#define ERROR_INPUT_FIRST_PIN 22
+#define ERROR_INPUT_COUNT 16 // Pins 22-37, one bit each
+
+#define IMD_FAULT_PIN 22
+#define BSPD_FAULT_PIN 23
+
+// Bit of a pin in the fault word
+#define ERROR_BIT(pin) ((uint16_t)(1u << ((pin)-ERROR_INPUT_FIRST_PIN)))
+
+// Lines that force zero torque and get a pin-change interrupt
+#define ERROR_CRITICAL_MASK                                                    \
+  (ERROR_BIT(IMD_FAULT_PIN) | ERROR_BIT(BSPD_FAULT_PIN))
+
+// Fault word frame: bytes 0-1 word (LE), 2-3 critical edges seen (LE,
+// saturating). Sent when the word changes and every ERROR_STATUS_PERIOD_MS.
+#define ERROR_STATUS_TX_ID 0x7E1
+#define ERROR_STATUS_PERIOD_MS 100
+
+/**
+ * @brief Configures pins 22-37 as inputs, takes the first snapshot and
+ * attaches the pin-change interrupts of the critical lines.
+ */
+void monitor_errors_setup();
+
+/**
+ * @brief Re-samples the fault word; logs and transmits it when it changes
+ * (and every ERROR_STATUS_PERIOD_MS). Run from the error_monitor task.
+ */
+void monitor_errors_loop();
+
+/**
+ * @brief Latest fault word. One load; safe from any context.
+ */
+uint16_t monitor_errors_get_word();
+
+/**
+ * @brief Critical lines currently in fault (0 = none).
+ */
+inline uint16_t monitor_errors_get_critical() {
+  return monitor_errors_get_word() & ERROR_CRITICAL_MASK;
+}
+
+/**
+ * @brief Edges seen on the critical lines since start-up, including pulses
+ * too short for the error_monitor task to catch.
+ */
+uint32_t monitor_errors_get_critical_edges();
+
+#endif // MONITOR_ERRORS_H
@@ -0,0 +1,82 @@
+/**
+ * @file mpu_sampler.h
+ * @brief Non-blocking MPU6050 accelerometer acquisition. The MPU6050 samples
+ * the accelerometer into its own FIFO at MPU_SAMPLER_RATE_HZ and pulses INT
+ * for each sample. On the Due, mpu_sampler_poll() then reads the FIFO count
+ * and only the accelerometer bytes over TWI1 with the PDC, one register step
+ * per call and never waiting on the bus, and publishes the average of what
+ * it read as one timestamped sample. Gyro and temperature are never read.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Wire the MPU6050 INT pin to MPU_INT_PIN (without it the FIFO is still
+//   read every MPU_SAMPLER_FALLBACK_US, just later).
+// - Confirm the accelerometer axes against the mounting in the car.
+
+#ifndef MPU_SAMPLER_H
+#define MPU_SAMPLER_H
+
+#include <stdint.h>
+
+#define MPU_INT_PIN 38 // MPU6050 INT (data ready), active high
+
+// Sample rate = 1 kHz / (1 + MPU_SAMPLER_RATE_DIV) with the DLPF on
+#define MPU_SAMPLER_RATE_DIV 4
+#define MPU_SAMPLER_RATE_HZ (1000 / (1 + MPU_SAMPLER_RATE_DIV)) // 200 Hz
+
+// Samples read from the FIFO per transfer at most (6 bytes each)
+#define MPU_SAMPLER_MAX_BURST 8
+
+// FIFO read without a data-ready pulse after this long (INT not wired)
+#define MPU_SAMPLER_FALLBACK_US 10000
+
+// A transfer still running after this long is aborted and counted
+#define MPU_SAMPLER_TRANSFER_TIMEOUT_US 2000
+
+// A sample older than this is stale (about 10 missed samples)
+#define MPU_SAMPLER_MAX_AGE_US 50000
+
+// Accelerometer full scale is +/- 4 g: 8192 LSB per g
+#define MPU_SAMPLER_LSB_PER_G 8192
+
+// One published sample, averaged over the FIFO entries of one transfer. With
+// more than MPU_SAMPLER_MAX_BURST entries waiting these are the oldest, and
+// the timestamp is moved back one sample period per entry left in the FIFO.
+typedef struct {
+  int32_t accel_mm_s2[3]; // X, Y, Z in mm/s^2 (sensor axes)
+  uint8_t averaged;       // FIFO entries in this sample
+  uint32_t sequence;      // Samples published so far (changes with each)
+  uint32_t timestamp_us;  // micros() of the data-ready pulse of the newest
+} MpuSample;
+
+/**
+ * @brief Finds the MPU6050, sets +/- 4 g, the 21 Hz DLPF, the sample rate,
+ * an accelerometer-only FIFO and the data-ready interrupt. Uses Wire and
+ * blocks; call from setup(). Wire must not be used after this.
+ * @return False if the sensor did not answer.
+ */
+bool mpu_sampler_begin();
+
+/**
+ * @brief Advances the TWI transfer as far as the hardware allows and
+ * returns; never waits. Call on every loop() pass.
+ */
+void mpu_sampler_poll();
+
+/**
+ * @brief Copies the newest sample.
+ * @param sample Output.
+ * @return False if the sampler is not running, nothing has been published
+ * yet or the newest sample is older than MPU_SAMPLER_MAX_AGE_US.
+ */
+bool mpu_sampler_read(MpuSample &sample);
+
+/**
+ * @brief Transfers aborted (NACK or timeout) plus FIFO overflows, since
+ * start-up. Should stay at 0.
+ */
+uint32_t mpu_sampler_get_error_count();
+
+#endif // MPU_SAMPLER_H
@@ -0,0 +1,118 @@
+/**
+ * @file profiler.h
+ * @brief Per-stage execution time profiler. Wrap a stage with
+ * PROFILE_SCOPE(stage) and every pass records its duration, read from the
+ * DWT cycle counter (ns on the host), into a log2 histogram with count, max
+ * and budget overruns. All storage is one static table; nothing is allocated
+ * and a record costs a few tens of cycles. Build with -DVCU_PROFILING=0 to
+ * compile every macro out.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Tune the per-stage budgets in profiler.cpp once real numbers from the car
+//   are available.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "cycle_counter.h"
+#include <stdint.h>
+
+#ifndef VCU_PROFILING
+#define VCU_PROFILING 1
+#endif
+
+// Bucket 0 holds durations below 2^PROFILE_HISTOGRAM_MIN_SHIFT ticks, bucket k
+// holds [2^(k + MIN_SHIFT - 1), 2^(k + MIN_SHIFT)), the last one everything
+// above (Due: 64 cycles = 0.76 us up to 12.5 ms).
+#define PROFILE_HISTOGRAM_BUCKETS 16
+#define PROFILE_HISTOGRAM_MIN_SHIFT 6
+
+// Profiled stages. Keep profiler.cpp's stage_info[] in the same order.
+typedef enum {
+  PROFILE_LOOP_PERIOD,      // Time between loop() passes (how long one blocks)
+  PROFILE_CAN_RX,           // CANManager::process_incoming_messages()
+  PROFILE_MOTOR_CONTROL,    // motor_control_update()
+  PROFILE_CAN_TX,           // CANManager::process_outgoing_messages()
+  PROFILE_BRAKE_LIGHT,      // brake_light()
+  PROFILE_MPU_READ,         // mpu_sampler_poll() step in loop()
+  PROFILE_DECEL_ESTIMATOR,  // decel_estimator_update()
+  PROFILE_ERROR_MONITOR,    // monitor_errors_loop()
+  PROFILE_BMS_SUPERVISION,  // BMSHandler::update_supervision()
+  PROFILE_BAMOCAR_REQUESTS, // motor_control_request_feedback()
+  PROFILE_DASHBOARD,        // dash_loop()
+  PROFILE_CAN_DIAGNOSTICS,  // CANManager::update_diagnostics()
+  PROFILE_DEBUG_STATUS,     // Status print task
+  PROFILE_STAGE_COUNT
+} ProfileStage;
+
+typedef struct {
+  uint32_t count;
+  uint32_t last_ticks;
+  uint32_t max_ticks;
+  uint32_t overruns;   // Passes longer than the stage budget
+  uint32_t last_mark;  // Previous profiler_mark() timestamp (periods only)
+  uint32_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+} ProfileStageStats;
+
+/**
+ * @brief Adds one duration to a stage. Safe from interrupts as long as each
+ * stage is only recorded from one context.
+ * @param stage Stage to update.
+ * @param ticks Duration in cycle counter ticks.
+ */
+void profiler_record(ProfileStage stage, uint32_t ticks);
+
+/**
+ * @brief Records the time since the previous call for the same stage (use for
+ * periods, e.g. PROFILE_LOOP_PERIOD). The first call only sets the mark.
+ */
+void profiler_mark(ProfileStage stage);
+
+/**
+ * @brief Statistics of one stage (read-only view of the static table).
+ */
+const ProfileStageStats &profiler_get_stats(ProfileStage stage);
+
+/**
+ * @brief Clears all counts, maxima and histograms.
+ */
+void profiler_reset();
+
+/**
+ * @brief Prints one line per stage that has run: count, last, max and budget
+ * (us), overruns and the non-empty histogram buckets as upper_edge:count, the
+ * edge in cycle counter ticks (CYCLE_COUNTER_UNIT).
+ */
+void profiler_print();
+
+/**
+ * @brief Serial console commands for the profiler: 'p' prints, 'r' resets.
+ * @param c Character read from Serial.
+ * @return False if c is not a profiler command.
+ */
+bool profiler_console_command(int c);
+
+// Records the time from construction to the end of the enclosing scope
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileStage stage)
+      : stage(stage), start(cycle_counter_read()) {}
+  ~ProfileScope() { profiler_record(stage, cycle_counter_read() - start); }
+
+private:
+  ProfileStage stage;
+  uint32_t start;
+};
+
+#if VCU_PROFILING
+#define PROFILE_SCOPE(stage) ProfileScope profile_scope_(stage)
+#define PROFILE_PERIOD(stage) profiler_mark(stage)
+#else
+#define PROFILE_SCOPE(stage) ((void)0)
+#define PROFILE_PERIOD(stage) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,104 @@
+/**
+ * @file scheduler.h
+ * @brief Static-table, multi-rate cooperative scheduler. Each task runs at a
+ * fixed period on a grid anchored at start-up (plus a per-task phase offset),
+ * so control rates no longer depend on whatever else ran in loop(). Tasks
+ * run to completion; when several are due, the one earliest in the table
+ * goes first, so list tasks fastest / most critical first.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Check the per-task max runtimes on the car (print_stats()) and keep the
+//   sum of every task's worst case below the control period.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#define SCHEDULER_MAX_TASKS 12
+
+typedef void (*TaskFunction)();
+
+// One row of the (const) task table
+typedef struct {
+  const char *name;
+  TaskFunction run;
+  uint32_t period_us;   // Release interval
+  uint32_t phase_us;    // Offset of the first release after begin()
+  uint32_t deadline_us; // Must finish within this of its release (0 = period)
+  bool enabled;         // Disabled rows are kept but never released
+} SchedulerTask;
+
+// Run-time statistics per task
+typedef struct {
+  uint32_t next_release_us; // Next time the task is due (micros())
+  uint32_t runs;
+  uint32_t deadline_misses;  // Finished after release + deadline
+  uint32_t skipped_releases; // Whole periods lost because the task ran late
+  uint32_t max_runtime_us;
+  uint32_t max_lateness_us; // Worst start time after release
+  bool enabled;
+} SchedulerTaskStats;
+
+class Scheduler {
+public:
+  Scheduler();
+
+  /**
+   * @brief Installs the task table and anchors every task's release grid at
+   * now + phase_us. Call at the end of setup().
+   * @param tasks Static task table, in priority order (highest first).
+   * @param count Number of rows (at most SCHEDULER_MAX_TASKS).
+   * @return False if the table is too large or a row has a zero period.
+   */
+  bool begin(const SchedulerTask *tasks, uint8_t count);
+
+  /**
+   * @brief Runs every task that is due, highest priority first, re-checking
+   * the table after each one. Returns once nothing is due; never waits. Call
+   * from loop().
+   */
+  void run_pending();
+
+  /**
+   * @brief Enables or disables a task at run time. A re-enabled task picks
+   * up its original grid at the next release after now.
+   */
+  void set_enabled(uint8_t index, bool enabled);
+
+  uint8_t get_task_count() const { return task_count; }
+  const SchedulerTask &get_task(uint8_t index) const { return tasks[index]; }
+  const SchedulerTaskStats &get_stats(uint8_t index) const {
+    return stats[index];
+  }
+
+  /**
+   * @brief Total deadline misses over all tasks since begin().
+   */
+  uint32_t get_total_deadline_misses() const;
+
+  /**
+   * @brief Clears runs, misses and maxima (keeps the release grid).
+   */
+  void reset_stats();
+
+  /**
+   * @brief Prints one line per task: period, runs, misses, skips, max
+   * runtime and max lateness.
+   */
+  void print_stats() const;
+
+private:
+  const SchedulerTask *tasks;
+  uint8_t task_count;
+  SchedulerTaskStats stats[SCHEDULER_MAX_TASKS];
+
+  void run_task(uint8_t index, uint32_t now_us);
+};
+
+extern Scheduler scheduler;
+
+#endif // SCHEDULER_H
@@ -0,0 +1,78 @@
+/**
+ * @file torque_isr.h
+ * @brief Optional hardware-timer mode for the torque control path. With
+ * VCU_TORQUE_ISR defined, a SAM3X TC interrupt runs the control tick (CAN in,
+ * safety checks, torque command, CAN out) at a fixed rate, independent of
+ * what the background scheduler is doing. Everything slow (I2C, Serial,
+ * dashboard) stays in the scheduler. The interrupt measures its own entry
+ * jitter and worst-case execution time, which bound pedal-to-inverter
+ * latency.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Run with -DVCU_TORQUE_ISR on the car at full CAN load and check
+//   torque_isr_print_stats(): max_cycles well below period_cycles, and no
+//   overruns.
+
+#ifndef TORQUE_ISR_H
+#define TORQUE_ISR_H
+
+#include <stdint.h>
+
+// TC1 channel 0 (TC3_IRQn) clocked at MCK/2 = 42 MHz
+#define TORQUE_ISR_TIMER_CLOCK_HZ 42000000UL
+
+// Lowest NVIC priority, so CAN RX, ADC DMA and UART interrupts preempt the
+// tick and never wait for it.
+#define TORQUE_ISR_IRQ_PRIORITY 15
+
+typedef void (*TorqueTickFunction)();
+
+// Timing of the interrupt, in core clock cycles (DWT, 84 MHz)
+typedef struct {
+  uint32_t period_cycles;     // Tick period
+  uint32_t runs;              // Ticks executed
+  uint32_t last_cycles;       // Execution time of the latest tick
+  uint32_t max_cycles;        // Worst-case execution time seen
+  uint32_t max_jitter_cycles; // Worst delay from timer match to tick start
+  uint32_t overruns;          // Ticks that took longer than one period
+} TorqueIsrStats;
+
+/**
+ * @brief Starts the timer interrupt. tick must be safe to run in interrupt
+ * context: no Serial, no I2C, no blocking waits.
+ * @param tick Function called once per period.
+ * @param rate_hz Tick rate (e.g. 1000).
+ * @return False if the rate is out of range or the build has no timer (host
+ * builds), in which case the caller keeps running tick from the scheduler.
+ */
+bool torque_isr_begin(TorqueTickFunction tick, uint32_t rate_hz);
+
+/**
+ * @brief Stops the timer interrupt.
+ */
+void torque_isr_end();
+
+/**
+ * @brief True while the timer interrupt is running.
+ */
+bool torque_isr_active();
+
+/**
+ * @brief Copies the timing statistics (consistent snapshot).
+ */
+void torque_isr_get_stats(TorqueIsrStats &stats);
+
+/**
+ * @brief Clears runs, maxima and overruns.
+ */
+void torque_isr_reset_stats();
+
+/**
+ * @brief Prints the statistics, converted to microseconds. Background only.
+ */
+void torque_isr_print_stats();
+
+#endif // TORQUE_ISR_H
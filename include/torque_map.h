@@ -0,0 +1,90 @@
+/**
+ * @file torque_map.h
+ * @brief Driver torque maps: drive torque as a function of pedal position and
+ * motor speed, one 9 x 9 table per event profile (endurance, acceleration,
+ * skidpad). Tables are const (flash) Q15 fractions of full torque; a lookup
+ * is a bilinear interpolation in integers, and switching profile swaps one
+ * pointer, so the control loop cost does not depend on the profile.
+ *
+ * A new profile is only requested by torque_map_select(); it becomes active
+ * when motor_control_update() calls torque_map_apply_pending(), which it does
+ * only with the pedal below APPS_REGEN_THRESHOLD_Q15 or torque inhibited.
+ * The drive torque therefore never steps while the driver holds the pedal.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+// TODO:
+// - Tune the profile tables with the drivers (torque_map.cpp); keep every
+//   row rising with pedal and 0 at 0 pedal.
+// - Set TORQUE_MAP_MAX_RPM to the motor's top speed.
+// - Decide whether the profile is picked from the dashboard or a switch
+//   instead of the Serial console ('m').
+
+#ifndef TORQUE_MAP_H
+#define TORQUE_MAP_H
+
+#include "fixed_point.h"
+#include <stdint.h>
+
+// Breakpoints: pedal every 1/8 of travel, speed every 1024 RPM from 0 to
+// TORQUE_MAP_MAX_RPM (power-of-two spacing: index and fraction are shifts)
+#define TORQUE_MAP_PEDAL_POINTS 9
+#define TORQUE_MAP_SPEED_POINTS 9
+#define TORQUE_MAP_PEDAL_SHIFT 12 // Q15 pedal >> 12 = interval (0-7)
+#define TORQUE_MAP_SPEED_SHIFT 10 // RPM >> 10 = interval (0-7)
+#define TORQUE_MAP_MAX_RPM                                                     \
+  ((TORQUE_MAP_SPEED_POINTS - 1) << TORQUE_MAP_SPEED_SHIFT) // 8192
+
+typedef enum {
+  TORQUE_PROFILE_ENDURANCE,    // Progressive, 80% cap, constant power above
+                               // 4096 RPM
+  TORQUE_PROFILE_ACCELERATION, // Linear, full torque at any speed
+  TORQUE_PROFILE_SKIDPAD,      // Soft (pedal squared), 60% cap
+  TORQUE_PROFILE_COUNT
+} TorqueProfile;
+
+// Profile at power-up: the linear pedal map the car always had
+#define TORQUE_MAP_DEFAULT_PROFILE TORQUE_PROFILE_ACCELERATION
+
+/**
+ * @brief Drive torque for a pedal position at a motor speed, from the active
+ * profile. Safe from the torque interrupt.
+ * @param pedal_q15 Pedal fraction (0 to Q15_ONE; <= 0 gives 0).
+ * @param speed_rpm Motor speed (either direction; clamped to
+ * TORQUE_MAP_MAX_RPM).
+ * @return Torque as a Q15 fraction of full scale (0 to Q15_ONE).
+ */
+q15_t torque_map_lookup_q15(q15_t pedal_q15, int32_t speed_rpm);
+
+/**
+ * @brief Requests a profile. It stays pending until the next
+ * torque_map_apply_pending() (off throttle or zero torque, see above); a
+ * later request replaces it. Out-of-range profiles are ignored.
+ */
+void torque_map_select(TorqueProfile profile);
+
+/**
+ * @brief Makes the pending profile active (one pointer store). Call only
+ * while no drive torque is being commanded from the map.
+ * @return true if the active profile changed.
+ */
+bool torque_map_apply_pending();
+
+/**
+ * @brief Currently active profile.
+ */
+TorqueProfile torque_map_get_profile();
+
+/**
+ * @brief Profile that will be active after the next apply (the active one if
+ * nothing is pending).
+ */
+TorqueProfile torque_map_get_pending();
+
+/**
+ * @brief Short name of a profile, for prints ("?" if out of range).
+ */
+const char *torque_map_profile_name(TorqueProfile profile);
+
+#endif // TORQUE_MAP_H
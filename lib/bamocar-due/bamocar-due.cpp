@@ -16,13 +16,16 @@
 //   (REG_ENABLE, 0x51) based on the Bamocar D3 manual. The current
 //   implementation uses example values that might not be correct.
 // - Verify the scaling and interpretation of N_ACTUAL in getSpeed().
-// - Verify the interpretation of response lengths in _parseMessage() if needed.
+// - Verify the Bamocar_Response register layouts in dbc/vcu.dbc against the
+//   Bamocar D3 manual.
 // - Implement or replace getMaxTorqueNm() with an accurate value for your
 // motor.
 
 #include "bamocar-due.h"
 #include "can_manager.h" // Include CANManager for sending messages
+#include "can_signals.h" // Bamocar_Response decoders (dbc/vcu.dbc)
 #include "header.h"      // For DEBUG_MODE
+#include "logger.h"      // Binary event log (non-blocking)
 
 // Define static instance if needed elsewhere, otherwise remove
 // Bamocar* Bamocar::instance = nullptr;
@@ -45,8 +48,17 @@ bool Bamocar::_sendCAN(M_data m_data) {
   msg.data = m_data.getData(); // Get the BytesUnion data payload
   msg.extended = false;        // Assuming standard CAN IDs
 
-  // Use the global CANManager instance to send the message
-  return can_manager.send_message(msg);
+  // Setpoints/commands jump ahead of data requests. A newer frame for the
+  // same register (or the same requested register) replaces a queued stale
+  // one, so the inverter always gets the freshest torque setpoint.
+  uint8_t reg_id = msg.data.bytes[0];
+  CanTxPriority priority = (reg_id == REG_REQUEST) ? CAN_TX_PRIORITY_REQUEST
+                                                   : CAN_TX_PRIORITY_SETPOINT;
+  uint16_t coalesce_key =
+      (reg_id == REG_REQUEST) ? ((reg_id << 8) | msg.data.bytes[1]) : reg_id;
+
+  // Use the global CANManager instance to queue the message
+  return can_manager.send_message(msg, priority, coalesce_key);
 }
 
 //------------------------------------------------------------------------------
@@ -59,6 +71,17 @@ bool Bamocar::_requestData(uint8_t requestedRegID, uint8_t interval) {
   return _sendCAN(M_data(REG_REQUEST, requestedRegID, interval));
 }
 
+//------------------------------------------------------------------------------
+// Register with CANManager RX Dispatch
+//------------------------------------------------------------------------------
+static void bamocar_rx_handler(const CAN_FRAME &msg, void *context) {
+  static_cast<Bamocar *>(context)->handle_incoming_frame(msg);
+}
+
+bool Bamocar::registerCANHandler(CANManager &can) {
+  return can.register_rx_handler(_txID, bamocar_rx_handler, this);
+}
+
 //------------------------------------------------------------------------------
 // Handle Incoming Frame (Public wrapper)
 //------------------------------------------------------------------------------
@@ -68,137 +91,104 @@ void Bamocar::handle_incoming_frame(const CAN_FRAME &msg) {
     _parseMessage(msg);
   } else {
     // This shouldn't happen if CANManager filters correctly, but log if it does
-    if (DEBUG_MODE) {
-      Serial.print("Bamocar: Received frame with unexpected ID: 0x");
-      Serial.print(msg.id, HEX);
-      Serial.print(" Expected: 0x");
-      Serial.println(_txID, HEX);
-    }
+    log_event<LOG_CAN_BAMOCAR_UNEXPECTED_ID>(msg.id, _txID);
   }
 }
 
 //------------------------------------------------------------------------------
-// Parse Received Message (Internal logic, largely unchanged)
+// Parse Received Message
 //------------------------------------------------------------------------------
+// Register layouts come from the multiplexed Bamocar_Response message in
+// dbc/vcu.dbc (decoders generated into can_signals.h).
+typedef can_signals::BamocarResponse BamocarMsg;
+
+static_assert(BamocarMsg::ID == STD_TX_ID,
+              "dbc/vcu.dbc and bamocar-registers.h disagree on the TX ID");
+
 void Bamocar::_parseMessage(const CAN_FRAME &msg) {
   // The first byte of the data payload in a Bamocar response
   // indicates which register the data belongs to.
-  uint8_t response_reg_id = msg.data.bytes[0];
-  int64_t receivedData; // Use 64-bit intermediate to avoid overflow issues
-
-  // Determine data size based on typical Bamocar response lengths
-  // Note: Bamocar manual should specify exact lengths for each register
-  // response. Common pattern: 3 bytes total (ID + 16-bit data) or 5 bytes total
-  // (ID + 32-bit data) The M_data class used for sending implies lengths 3
-  // or 5. Responses might have different lengths (e.g., 4 or 8 bytes total
-  // frame length).
-  // TODO: Verify this length assumption against Bamocar manual if issues arise.
-  if (msg.length <=
-      4) { // Assumes RegID + 16-bit data + maybe padding/unused bytes
-    receivedData = _getReceived16Bit(msg);
-  } else { // Assumes RegID + 32-bit data + maybe padding/unused bytes
-    receivedData = _getReceived32Bit(msg);
+  const uint8_t *d = msg.data.bytes;
+  uint8_t response_reg_id = BamocarMsg::reg_id(d);
+
+  // Every handled register carries at least 16 bits after the register ID;
+  // a shorter frame is dropped rather than read as zero
+  if (msg.length < BamocarMsg::READY_MIN_DLC) {
+    log_event<LOG_CAN_BAMOCAR_SHORT_FRAME>(response_reg_id, msg.length);
+    return;
   }
 
   // Update internal state based on the register ID in the response
   switch (response_reg_id) {
-  case REG_STATUS: // 0x40 - Usually 32-bit status flags
-                   // Ensure STATUS is uint32_t in _rcvd struct
-    _rcvd.STATUS = (uint32_t)_getReceived32Bit(
-        msg); // Re-parse as 32-bit explicitly if needed
+  case REG_STATUS: // 0x40 - 32-bit status flags (0 if only 16 bits came)
+    _rcvd.STATUS = (msg.length >= BamocarMsg::STATUS_MIN_DLC)
+                       ? BamocarMsg::status(d)
+                       : 0;
     break;
 
   case REG_READY: // 0xE2 - Usually 16-bit
-    _rcvd.READY = (uint16_t)receivedData;
+    _rcvd.READY = BamocarMsg::ready(d);
     break;
 
   case REG_N_ACTUAL: // 0x30 - Actual Speed (RPM), 16-bit signed
-    _rcvd.N_ACTUAL = (int16_t)receivedData;
+    _rcvd.N_ACTUAL = BamocarMsg::n_actual(d);
+    _speedRxCount++;
     break;
 
   case REG_N_MAX: // 0xC8 - Max Speed (RPM), 16-bit signed
-    _rcvd.N_MAX = (int16_t)receivedData;
+    _rcvd.N_MAX = BamocarMsg::n_max(d);
     break;
 
   case REG_I_ACTUAL: // 0x20 - Actual Current (relative), 16-bit unsigned
-    _rcvd.I_ACTUAL = (uint16_t)receivedData;
+    _rcvd.I_ACTUAL = BamocarMsg::i_actual(d);
     break;
 
   case REG_I_DEVICE: // 0xC6 - Device Current Limit (Amps), 16-bit unsigned
-    _rcvd.I_DEVICE = (uint16_t)receivedData;
+    _rcvd.I_DEVICE = BamocarMsg::i_device(d);
     break;
 
   case REG_I_200PC: // 0xD9 - 200% Current Ref (relative), 16-bit unsigned
-    _rcvd.I_200PC = (uint16_t)receivedData;
+    _rcvd.I_200PC = BamocarMsg::i200pc(d);
     break;
 
   case REG_TORQUE: // 0x90 - Actual Torque (relative), 16-bit signed
-    _rcvd.TORQUE = (int16_t)receivedData;
+    _rcvd.TORQUE = BamocarMsg::torque(d);
     break;
 
   case REG_RAMP_ACC: // 0x35 - Accel Ramp, 16-bit unsigned
-    _rcvd.RAMP_ACC = (uint16_t)receivedData;
+    _rcvd.RAMP_ACC = BamocarMsg::ramp_acc(d);
     break;
 
   case REG_RAMP_DEC: // 0xED - Decel Ramp, 16-bit unsigned
-    _rcvd.RAMP_DEC = (uint16_t)receivedData;
+    _rcvd.RAMP_DEC = BamocarMsg::ramp_dec(d);
     break;
 
   case REG_TEMP_MOTOR: // 0x49 - Motor Temp (°C * 10), 16-bit unsigned
-    _rcvd.TEMP_MOTOR = (uint16_t)receivedData;
+    _rcvd.TEMP_MOTOR = BamocarMsg::temp_motor(d);
     break;
 
   case REG_TEMP_IGBT: // 0x4A - Controller Temp (°C * 10), 16-bit unsigned
-    _rcvd.TEMP_IGBT = (uint16_t)receivedData;
+    _rcvd.TEMP_IGBT = BamocarMsg::temp_igbt(d);
     break;
 
   case REG_TEMP_AIR: // 0x4B - Air Temp (°C * 10), 16-bit unsigned
-    _rcvd.TEMP_AIR = (uint16_t)receivedData;
+    _rcvd.TEMP_AIR = BamocarMsg::temp_air(d);
     break;
 
   case REG_HARD_ENABLED: // 0xE8 - Hardware Enable Status, 16-bit unsigned
-    _rcvd.HARD_ENABLED = (uint16_t)receivedData;
+    _rcvd.HARD_ENABLED = BamocarMsg::hard_enabled(d);
     break;
 
-    // Add cases for any other registers you are reading...
+    // Add cases for any other registers you are reading (and a multiplexed
+    // signal for each in dbc/vcu.dbc)...
 
   default:
     // Ignore responses for registers we didn't request or don't handle
-    if (DEBUG_MODE) {
-      Serial.print("Bamocar: Received unhandled register response ID: 0x");
-      Serial.println(response_reg_id, HEX);
-    }
+    log_event<LOG_CAN_BAMOCAR_UNHANDLED_REG>(response_reg_id);
     break;
   }
 }
 
-//------------------------------------------------------------------------------
-// Get 16/32 Bit Data from Frame (Internal logic, largely unchanged)
-// Assumes Little Endian format (LSB first in bytes 1, 2, ...)
-//------------------------------------------------------------------------------
-int16_t Bamocar::_getReceived16Bit(const CAN_FRAME &msg) {
-  // Assumes data starts at byte 1 (byte 0 is register ID)
-  if (msg.length < 3)
-    return 0; // Need at least 3 bytes (ID + 2 data bytes)
-  int16_t val;
-  val = msg.data.bytes[1];         // LSB
-  val |= (msg.data.bytes[2] << 8); // MSB
-  return val;
-}
-
-int32_t Bamocar::_getReceived32Bit(const CAN_FRAME &msg) {
-  // Assumes data starts at byte 1
-  if (msg.length < 5)
-    return 0; // Need at least 5 bytes (ID + 4 data bytes)
-  int32_t val;
-  val = msg.data.bytes[1]; // LSB
-  val |= (msg.data.bytes[2] << 8);
-  val |= ((uint32_t)msg.data.bytes[3]
-          << 16); // Use uint32_t cast for intermediate shift
-  val |= ((uint32_t)msg.data.bytes[4] << 24); // MSB
-  return val;
-}
-
 // ----------------------------------------------------------------------------
 // --- Public Interface Function Implementations ---
 // (Largely unchanged, but rely on updated _sendCAN and parsed _rcvd data)
@@ -213,6 +203,11 @@ float Bamocar::getSpeed() {
   return (float)_rcvd.N_MAX * ((float)_rcvd.N_ACTUAL / 32767.0f);
 }
 
+int16_t Bamocar::getSpeedRpm() {
+  // Same scaling as getSpeed(), truncated to whole RPM (one integer divide)
+  return (int16_t)(((int32_t)_rcvd.N_MAX * _rcvd.N_ACTUAL) / 32767);
+}
+
 bool Bamocar::setSpeed(int16_t speed) {
   // REG_N_CMD (0x31) is the command to set speed
   return _sendCAN(M_data(REG_N_CMD, speed));
@@ -255,8 +250,17 @@ bool Bamocar::setTorque(float torque) {
     torque = -TORQUE_MAX_PERCENT; // Allow negative torque if needed
 
   // Convert fraction to 16-bit signed integer (scaling factor 32760)
-  int16_t torque16 = (int16_t)(torque * 32760.0f);
+  return setTorqueRaw((int16_t)(torque * (float)TORQUE_REG_FULL_SCALE));
+}
+
+bool Bamocar::setTorqueQ15(int16_t torque_q15) {
+  // Q15 is already limited to [-1.0, 1.0). Divide (not shift) so negative
+  // values truncate toward zero like the float conversion in setTorque().
+  return setTorqueRaw(
+      (int16_t)(((int32_t)torque_q15 * TORQUE_REG_FULL_SCALE) / 32768));
+}
 
+bool Bamocar::setTorqueRaw(int16_t torque16) {
   // REG_TORQUE (0x90) is also the command register ID for setting torque
   return _sendCAN(M_data(REG_TORQUE, torque16));
 }
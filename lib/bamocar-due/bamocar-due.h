@@ -22,6 +22,7 @@
 
 // #define CAN_TIMEOUT 0.01
 #define TORQUE_MAX_PERCENT 1.00
+#define TORQUE_REG_FULL_SCALE 32760 // REG_TORQUE value for 100% torque
 
 // Forward declaration
 class CANManager;
@@ -95,6 +96,9 @@ public:
 
   // --- Public Interface Functions (Unchanged signatures) ---
   float getSpeed();
+  int16_t getSpeedRpm(); // Integer version of getSpeed() for the control loop
+  // N_ACTUAL responses parsed so far; changes with each new speed value
+  uint32_t getSpeedUpdateCount() const { return _speedRxCount; }
   bool setSpeed(int16_t speed);
   bool requestSpeed(uint8_t interval = INTVL_IMMEDIATE);
 
@@ -103,6 +107,8 @@ public:
 
   float getTorque();
   bool setTorque(float torque);
+  bool setTorqueQ15(int16_t torque_q15); // Fraction in Q15 (32768 = 100%)
+  bool setTorqueRaw(int16_t torque16);   // Raw REG_TORQUE value
   bool requestTorque(uint8_t interval = INTVL_IMMEDIATE);
   float getMaxTorqueNm(); // Helper function for regen scaling
 
@@ -130,6 +136,14 @@ public:
   } // Getter for CANManager filter setup
   uint16_t getRxID() const { return _rxID; } // Getter
 
+  /**
+   * @brief Claims this instance's response ID (_txID) in the CANManager
+   * dispatch registry. Call before CANManager::initialize().
+   * @param can The CANManager that receives the frames.
+   * @return True if the ID was registered.
+   */
+  bool registerCANHandler(CANManager &can);
+
   /**
    * @brief Public function to handle incoming CAN frames intended for this
    * Bamocar instance. Called by CANManager.
@@ -141,6 +155,7 @@ protected:
   // static Bamocar *instance; // Keep if needed
   uint16_t _rxID; // ID we send commands TO
   uint16_t _txID; // ID we receive responses FROM
+  volatile uint32_t _speedRxCount = 0; // N_ACTUAL responses parsed
 
   // Structure to hold received data (Unchanged)
   struct _rcvd {
@@ -175,18 +190,4 @@ protected:
    * @param msg The received CAN_FRAME.
    */
   void _parseMessage(const CAN_FRAME &msg); // Made const reference
-
-  /**
-   * @brief Extracts 16-bit data from a received CAN frame.
-   * @param msg The received CAN_FRAME.
-   * @return The extracted 16-bit value.
-   */
-  int16_t _getReceived16Bit(const CAN_FRAME &msg); // Made const reference
-
-  /**
-   * @brief Extracts 32-bit data from a received CAN frame.
-   * @param msg The received CAN_FRAME.
-   * @return The extracted 32-bit value.
-   */
-  int32_t _getReceived32Bit(const CAN_FRAME &msg); // Made const reference
 };
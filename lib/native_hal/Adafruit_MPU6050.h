@@ -0,0 +1,44 @@
+/**
+ * @file Adafruit_MPU6050.h
+ * @brief Host (native) replacement for the Adafruit MPU6050 driver. The
+ * acceleration it reports is scripted with native_hal::set_acceleration().
+ * Only compiled for [env:native].
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef NATIVE_HAL_ADAFRUIT_MPU6050_H
+#define NATIVE_HAL_ADAFRUIT_MPU6050_H
+
+#include <Adafruit_Sensor.h>
+
+typedef enum {
+  MPU6050_RANGE_2_G,
+  MPU6050_RANGE_4_G,
+  MPU6050_RANGE_8_G,
+  MPU6050_RANGE_16_G,
+} mpu6050_accel_range_t;
+
+typedef enum {
+  MPU6050_BAND_260_HZ,
+  MPU6050_BAND_184_HZ,
+  MPU6050_BAND_94_HZ,
+  MPU6050_BAND_44_HZ,
+  MPU6050_BAND_21_HZ,
+  MPU6050_BAND_10_HZ,
+  MPU6050_BAND_5_HZ,
+} mpu6050_bandwidth_t;
+
+class Adafruit_MPU6050 {
+public:
+  bool begin(uint8_t address = 0x68) {
+    (void)address;
+    return true;
+  }
+  void setAccelerometerRange(mpu6050_accel_range_t range) { (void)range; }
+  void setFilterBandwidth(mpu6050_bandwidth_t bandwidth) { (void)bandwidth; }
+  bool getEvent(sensors_event_t *accel, sensors_event_t *gyro,
+                sensors_event_t *temp);
+};
+
+#endif // NATIVE_HAL_ADAFRUIT_MPU6050_H
@@ -0,0 +1,30 @@
+/**
+ * @file Adafruit_Sensor.h
+ * @brief Host (native) subset of the Adafruit unified sensor types.
+ * Only compiled for [env:native].
+ */
+
+#ifndef NATIVE_HAL_ADAFRUIT_SENSOR_H
+#define NATIVE_HAL_ADAFRUIT_SENSOR_H
+
+#include <Arduino.h>
+
+typedef struct {
+  float x;
+  float y;
+  float z;
+} sensors_vec_t;
+
+typedef struct {
+  int32_t version;
+  int32_t sensor_id;
+  int32_t type;
+  int32_t timestamp;
+  union {
+    sensors_vec_t acceleration;
+    sensors_vec_t gyro;
+    float temperature;
+  };
+} sensors_event_t;
+
+#endif // NATIVE_HAL_ADAFRUIT_SENSOR_H
@@ -0,0 +1,141 @@
+/**
+ * @file Arduino.h
+ * @brief Host (native) replacement for the Arduino Due core API used by the
+ * VCU. Timing runs on a virtual clock and analog/digital inputs are scripted
+ * through native_hal.h, so control code can be tested and timed off-target.
+ * Only compiled for [env:native].
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef NATIVE_HAL_ARDUINO_H
+#define NATIVE_HAL_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+// ------------ CONSTANTS ------------
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 2
+#define FALLING 3
+#define RISING 4
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PI 3.1415926535897932384626433832795
+
+// Arduino Due analog pin numbers
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+
+#define NATIVE_HAL_NUM_PINS 80
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// Function templates rather than macros: bamocar-due.h #undefs min/max.
+template <class T, class U>
+inline typename std::common_type<T, U>::type min(T a, U b) {
+  return a < b ? a : b;
+}
+template <class T, class U>
+inline typename std::common_type<T, U>::type max(T a, U b) {
+  return a > b ? a : b;
+}
+
+// ------------ TIME (virtual clock) ------------
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// ------------ I/O (scripted) ------------
+void pinMode(uint32_t pin, uint32_t mode);
+void digitalWrite(uint32_t pin, uint32_t value);
+int digitalRead(uint32_t pin);
+uint32_t analogRead(uint32_t pin);
+void analogReadResolution(int bits);
+
+// ------------ INTERRUPTS ------------
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode);
+void detachInterrupt(uint32_t pin);
+void noInterrupts();
+void interrupts();
+
+// ------------ SERIAL ------------
+/**
+ * @brief Minimal Print/HardwareSerial replacement. Output goes to stdout when
+ * echo is enabled (see native_hal::set_serial_echo()), otherwise it is
+ * discarded.
+ */
+class HardwareSerial {
+public:
+  explicit HardwareSerial(const char *name) : _name(name) {}
+
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  operator bool() const { return true; }
+  int available() { return 0; }
+  int read() { return -1; }
+  int availableForWrite() { return 128; }
+  void flush();
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return print(str); }
+
+  size_t print(const char *str);
+  size_t print(char c);
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) {
+    return print((unsigned long)value, base);
+  }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+
+  size_t println() { return print("\r\n"); }
+  template <class T> size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <class T> size_t println(T value, int format) {
+    size_t n = print(value, format);
+    return n + println();
+  }
+
+private:
+  const char *_name;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif // NATIVE_HAL_ARDUINO_H
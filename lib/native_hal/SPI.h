@@ -0,0 +1,12 @@
+/**
+ * @file SPI.h
+ * @brief Host (native) placeholder for the Arduino SPI library (unused by the
+ * VCU logic, included by header.h). Only compiled for [env:native].
+ */
+
+#ifndef NATIVE_HAL_SPI_H
+#define NATIVE_HAL_SPI_H
+
+#include <Arduino.h>
+
+#endif // NATIVE_HAL_SPI_H
@@ -0,0 +1,48 @@
+/**
+ * @file Wire.h
+ * @brief Host (native) replacement for the Arduino Wire (I2C) library.
+ * Transactions succeed and reads return zeros. Only compiled for
+ * [env:native].
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef NATIVE_HAL_WIRE_H
+#define NATIVE_HAL_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  void begin() {}
+  void setClock(uint32_t frequency) { (void)frequency; }
+  void beginTransmission(uint8_t address) { (void)address; }
+  uint8_t endTransmission(bool stop = true) {
+    (void)stop;
+    return 0;
+  }
+  size_t write(uint8_t data) {
+    (void)data;
+    return 1;
+  }
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool stop = true) {
+    (void)address;
+    (void)stop;
+    _pending = quantity;
+    return quantity;
+  }
+  int available() { return _pending; }
+  int read() {
+    if (_pending == 0)
+      return -1;
+    _pending--;
+    return 0;
+  }
+
+private:
+  uint8_t _pending = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // NATIVE_HAL_WIRE_H
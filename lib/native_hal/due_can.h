@@ -0,0 +1,97 @@
+/**
+ * @file due_can.h
+ * @brief Host (native) replacement for the collin80 due_can library.
+ * Can0 is an in-process loopback: frames sent by the VCU are logged for the
+ * host to inspect, frames injected by the host go through the mailbox filters
+ * and the general callback exactly like the SAM3X mailbox interrupt would.
+ * Only compiled for [env:native].
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef NATIVE_HAL_DUE_CAN_H
+#define NATIVE_HAL_DUE_CAN_H
+
+#include <Arduino.h>
+
+#define CAN_BPS_1000K 1000000
+#define CAN_BPS_500K 500000
+#define CAN_BPS_250K 250000
+#define CAN_BPS_125K 125000
+
+#define CAN_MSR_MRDY (0x1u << 23) // Mailbox ready bit (TX mailbox free)
+
+#define NATIVE_CAN_MAILBOXES 8
+#define NATIVE_CAN_FIFO_SIZE 64
+
+typedef union {
+  uint64_t value;
+  struct {
+    uint32_t low;
+    uint32_t high;
+  };
+  struct {
+    uint16_t s0;
+    uint16_t s1;
+    uint16_t s2;
+    uint16_t s3;
+  };
+  uint8_t bytes[8];
+  uint8_t byte[8];
+} BytesUnion;
+
+typedef struct {
+  uint32_t id;
+  uint32_t fid;
+  uint8_t rtr;
+  uint8_t priority;
+  uint8_t extended;
+  uint16_t time;
+  uint8_t length;
+  BytesUnion data;
+} CAN_FRAME;
+
+class CANRaw {
+public:
+  CANRaw();
+
+  uint32_t begin(uint32_t baudrate);
+  int setRXFilter(uint8_t mailbox, uint32_t id, uint32_t mask, bool extended);
+  int setNumTXBoxes(int txboxes);
+  void setGeneralCallback(void (*cb)(CAN_FRAME *));
+  uint32_t mailbox_get_status(uint8_t mailbox);
+
+  bool sendFrame(CAN_FRAME &frame);
+  uint32_t available();
+  uint32_t read(CAN_FRAME &frame);
+
+  // --- Host side (see native_hal.h wrappers) ---
+  bool inject(const CAN_FRAME &frame); // Deliver as if received on the bus
+  bool pop_sent(CAN_FRAME &frame);     // Oldest frame the VCU sent
+  uint32_t sent_pending() const;
+  void set_loopback(bool enable) { _loopback = enable; }
+  void set_tx_busy(bool busy) { _tx_busy = busy; }
+
+private:
+  struct Filter {
+    bool enabled;
+    uint32_t id;
+    uint32_t mask;
+    bool extended;
+  };
+  Filter _filters[NATIVE_CAN_MAILBOXES];
+  int _num_tx_boxes;
+  void (*_general_cb)(CAN_FRAME *);
+  bool _loopback;
+  bool _tx_busy;
+
+  CAN_FRAME _rx_fifo[NATIVE_CAN_FIFO_SIZE]; // When no callback is set
+  uint32_t _rx_head, _rx_count;
+  CAN_FRAME _tx_log[NATIVE_CAN_FIFO_SIZE];
+  uint32_t _tx_head, _tx_count;
+};
+
+extern CANRaw Can0;
+extern CANRaw Can1;
+
+#endif // NATIVE_HAL_DUE_CAN_H
@@ -0,0 +1,311 @@
+/**
+ * @file native_hal.cpp
+ * @brief Implements the native (host) HAL: virtual clock, scripted I/O,
+ * Serial to stdout, Can0 loopback and a default main() that runs the
+ * Arduino setup()/loop() pair. Only compiled for [env:native].
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "native_hal.h"
+#include <Adafruit_MPU6050.h>
+#include <Wire.h>
+
+HardwareSerial Serial("Serial");
+HardwareSerial Serial1("Serial1");
+CANRaw Can0;
+CANRaw Can1;
+TwoWire Wire;
+
+static unsigned long virtual_micros = 0;
+static uint32_t analog_values[NATIVE_HAL_NUM_PINS];
+static uint32_t (*analog_script)(uint32_t, unsigned long) = nullptr;
+static int digital_inputs[NATIVE_HAL_NUM_PINS];
+static int digital_outputs[NATIVE_HAL_NUM_PINS];
+static void (*pin_isr[NATIVE_HAL_NUM_PINS])(void);
+static uint32_t pin_isr_mode[NATIVE_HAL_NUM_PINS];
+static float accel_xyz[3] = {0.0f, 0.0f, 9.81f};
+static bool serial_echo = true;
+
+//------------------------------------------------------------------------------
+// Arduino Core: Time
+//------------------------------------------------------------------------------
+unsigned long millis() { return virtual_micros / 1000; }
+unsigned long micros() { return virtual_micros; }
+void delay(unsigned long ms) { virtual_micros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { virtual_micros += us; }
+
+//------------------------------------------------------------------------------
+// Arduino Core: I/O
+//------------------------------------------------------------------------------
+void pinMode(uint32_t pin, uint32_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint32_t pin, uint32_t value) {
+  if (pin < NATIVE_HAL_NUM_PINS)
+    digital_outputs[pin] = value ? HIGH : LOW;
+}
+
+int digitalRead(uint32_t pin) {
+  return pin < NATIVE_HAL_NUM_PINS ? digital_inputs[pin] : LOW;
+}
+
+uint32_t analogRead(uint32_t pin) {
+  if (analog_script != nullptr)
+    return analog_script(pin, virtual_micros);
+  return pin < NATIVE_HAL_NUM_PINS ? analog_values[pin] : 0;
+}
+
+void analogReadResolution(int bits) { (void)bits; }
+
+void attachInterrupt(uint32_t pin, void (*callback)(void), uint32_t mode) {
+  if (pin < NATIVE_HAL_NUM_PINS) {
+    pin_isr[pin] = callback;
+    pin_isr_mode[pin] = mode;
+  }
+}
+
+void detachInterrupt(uint32_t pin) {
+  if (pin < NATIVE_HAL_NUM_PINS)
+    pin_isr[pin] = nullptr;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+//------------------------------------------------------------------------------
+// Serial
+//------------------------------------------------------------------------------
+void HardwareSerial::flush() {
+  if (serial_echo)
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (serial_echo && this == &Serial)
+    fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  if (serial_echo && this == &Serial)
+    fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+size_t HardwareSerial::print(const char *str) {
+  return write((const uint8_t *)str, strlen(str));
+}
+
+size_t HardwareSerial::print(char c) { return write((uint8_t)c); }
+
+size_t HardwareSerial::print(long value, int base) {
+  if (base == DEC) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%ld", value);
+    return print(buffer);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+  char buffer[72];
+  char *p = &buffer[sizeof(buffer) - 1];
+  *p = '\0';
+  if (base < 2)
+    base = DEC;
+  do {
+    unsigned digit = value % base;
+    *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value != 0);
+  return print(p);
+}
+
+size_t HardwareSerial::print(double value, int digits) {
+  char buffer[48];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return print(buffer);
+}
+
+//------------------------------------------------------------------------------
+// MPU6050
+//------------------------------------------------------------------------------
+bool Adafruit_MPU6050::getEvent(sensors_event_t *accel, sensors_event_t *gyro,
+                                sensors_event_t *temp) {
+  memset(accel, 0, sizeof(*accel));
+  memset(gyro, 0, sizeof(*gyro));
+  memset(temp, 0, sizeof(*temp));
+  accel->acceleration.x = accel_xyz[0];
+  accel->acceleration.y = accel_xyz[1];
+  accel->acceleration.z = accel_xyz[2];
+  temp->temperature = 25.0f;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// CAN Loopback
+//------------------------------------------------------------------------------
+CANRaw::CANRaw()
+    : _num_tx_boxes(1), _general_cb(nullptr), _loopback(false),
+      _tx_busy(false), _rx_head(0), _rx_count(0), _tx_head(0), _tx_count(0) {
+  memset(_filters, 0, sizeof(_filters));
+}
+
+uint32_t CANRaw::begin(uint32_t baudrate) {
+  (void)baudrate;
+  return 1;
+}
+
+int CANRaw::setRXFilter(uint8_t mailbox, uint32_t id, uint32_t mask,
+                        bool extended) {
+  if (mailbox >= NATIVE_CAN_MAILBOXES - _num_tx_boxes)
+    return -1;
+  _filters[mailbox].enabled = true;
+  _filters[mailbox].id = id & mask;
+  _filters[mailbox].mask = mask;
+  _filters[mailbox].extended = extended;
+  return mailbox;
+}
+
+int CANRaw::setNumTXBoxes(int txboxes) {
+  _num_tx_boxes = constrain(txboxes, 0, NATIVE_CAN_MAILBOXES);
+  return _num_tx_boxes;
+}
+
+void CANRaw::setGeneralCallback(void (*cb)(CAN_FRAME *)) { _general_cb = cb; }
+
+uint32_t CANRaw::mailbox_get_status(uint8_t mailbox) {
+  (void)mailbox;
+  return _tx_busy ? 0 : CAN_MSR_MRDY;
+}
+
+bool CANRaw::sendFrame(CAN_FRAME &frame) {
+  if (_tx_busy)
+    return false;
+  if (_tx_count == NATIVE_CAN_FIFO_SIZE) { // Keep the newest frames
+    _tx_head = (_tx_head + 1) % NATIVE_CAN_FIFO_SIZE;
+    _tx_count--;
+  }
+  _tx_log[(_tx_head + _tx_count) % NATIVE_CAN_FIFO_SIZE] = frame;
+  _tx_count++;
+  if (_loopback)
+    inject(frame);
+  return true;
+}
+
+uint32_t CANRaw::available() { return _rx_count; }
+
+uint32_t CANRaw::read(CAN_FRAME &frame) {
+  if (_rx_count == 0)
+    return 0;
+  frame = _rx_fifo[_rx_head];
+  _rx_head = (_rx_head + 1) % NATIVE_CAN_FIFO_SIZE;
+  _rx_count--;
+  return 1;
+}
+
+bool CANRaw::inject(const CAN_FRAME &frame) {
+  for (int mb = 0; mb < NATIVE_CAN_MAILBOXES - _num_tx_boxes; mb++) {
+    const Filter &f = _filters[mb];
+    if (!f.enabled || f.extended != (bool)frame.extended ||
+        (frame.id & f.mask) != f.id)
+      continue;
+
+    CAN_FRAME copy = frame;
+    if (_general_cb != nullptr) {
+      _general_cb(&copy); // Runs "in interrupt context" on target
+    } else if (_rx_count < NATIVE_CAN_FIFO_SIZE) {
+      _rx_fifo[(_rx_head + _rx_count) % NATIVE_CAN_FIFO_SIZE] = copy;
+      _rx_count++;
+    }
+    return true;
+  }
+  return false; // No mailbox accepted it
+}
+
+bool CANRaw::pop_sent(CAN_FRAME &frame) {
+  if (_tx_count == 0)
+    return false;
+  frame = _tx_log[_tx_head];
+  _tx_head = (_tx_head + 1) % NATIVE_CAN_FIFO_SIZE;
+  _tx_count--;
+  return true;
+}
+
+uint32_t CANRaw::sent_pending() const { return _tx_count; }
+
+//------------------------------------------------------------------------------
+// Host Controls
+//------------------------------------------------------------------------------
+namespace native_hal {
+
+void set_micros(unsigned long us) { virtual_micros = us; }
+void advance_micros(unsigned long us) { virtual_micros += us; }
+void advance_millis(unsigned long ms) { virtual_micros += ms * 1000; }
+
+void set_analog(uint32_t pin, uint32_t raw) {
+  if (pin < NATIVE_HAL_NUM_PINS)
+    analog_values[pin] = raw;
+}
+
+void set_analog_script(uint32_t (*script)(uint32_t, unsigned long)) {
+  analog_script = script;
+}
+
+void set_digital(uint32_t pin, int value) {
+  if (pin >= NATIVE_HAL_NUM_PINS)
+    return;
+  int old_value = digital_inputs[pin];
+  digital_inputs[pin] = value ? HIGH : LOW;
+  if (pin_isr[pin] == nullptr || old_value == digital_inputs[pin])
+    return;
+  uint32_t mode = pin_isr_mode[pin];
+  if (mode == CHANGE || (mode == RISING && value) ||
+      (mode == FALLING && !value)) {
+    pin_isr[pin]();
+  }
+}
+
+int get_digital_output(uint32_t pin) {
+  return pin < NATIVE_HAL_NUM_PINS ? digital_outputs[pin] : LOW;
+}
+
+void set_acceleration(float x, float y, float z) {
+  accel_xyz[0] = x;
+  accel_xyz[1] = y;
+  accel_xyz[2] = z;
+}
+
+void set_serial_echo(bool enable) { serial_echo = enable; }
+
+} // namespace native_hal
+
+//------------------------------------------------------------------------------
+// Default Entry Point
+//------------------------------------------------------------------------------
+// Runs setup() once, then loop() with the virtual clock advancing 1 ms per
+// pass. VCU_NATIVE_LOOPS sets the number of passes (default 1000). Host
+// tools that need their own driver define main() and this one is dropped.
+void setup();
+void loop();
+
+__attribute__((weak)) int main() {
+  const char *echo = getenv("VCU_SERIAL_ECHO");
+  if (echo != nullptr && echo[0] == '0')
+    native_hal::set_serial_echo(false);
+
+  const char *loops_env = getenv("VCU_NATIVE_LOOPS");
+  unsigned long loops = loops_env != nullptr ? strtoul(loops_env, nullptr, 10)
+                                             : 1000;
+
+  setup();
+  for (unsigned long i = 0; i < loops; i++) {
+    loop();
+    native_hal::advance_millis(1);
+  }
+  fflush(stdout);
+  return 0;
+}
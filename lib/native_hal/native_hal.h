@@ -0,0 +1,89 @@
+/**
+ * @file native_hal.h
+ * @brief Host-side controls for the native HAL: virtual clock, scripted
+ * analog/digital inputs, MPU acceleration and the Can0 loopback.
+ * Used by host tools and benchmarks; VCU code never includes this.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <Arduino.h>
+#include <due_can.h>
+
+namespace native_hal {
+
+// --- Virtual clock ---
+void set_micros(unsigned long us);
+void advance_micros(unsigned long us);
+void advance_millis(unsigned long ms);
+
+// --- Scripted inputs ---
+/**
+ * @brief Sets the raw value analogRead() returns for a pin.
+ * @param pin Arduino pin number (e.g. A6).
+ * @param raw Raw ADC counts at the current analogReadResolution().
+ */
+void set_analog(uint32_t pin, uint32_t raw);
+
+/**
+ * @brief Optional script called on every analogRead(); overrides set_analog().
+ * @param script Returns the raw value for (pin, micros()), or nullptr to clear.
+ */
+void set_analog_script(uint32_t (*script)(uint32_t pin, unsigned long now_us));
+
+/**
+ * @brief Drives a digital input. Fires any handler attached with
+ * attachInterrupt() whose mode matches the edge.
+ */
+void set_digital(uint32_t pin, int value);
+
+/**
+ * @brief Last value the VCU wrote with digitalWrite().
+ */
+int get_digital_output(uint32_t pin);
+
+/**
+ * @brief Acceleration (m/s^2) returned by Adafruit_MPU6050::getEvent().
+ */
+void set_acceleration(float x, float y, float z);
+
+// --- Serial ---
+/**
+ * @brief Enables/disables copying Serial output to stdout (default: on,
+ * override with the VCU_SERIAL_ECHO=0 environment variable). Serial1 (the
+ * Nextion link) is never copied.
+ */
+void set_serial_echo(bool enable);
+
+// --- CAN loopback (Can0) ---
+/**
+ * @brief Delivers a frame to Can0 as if it arrived on the bus: mailbox
+ * filters are applied, then the general callback runs (the RX "ISR").
+ * @return True if a mailbox accepted the frame.
+ */
+inline bool can_inject(const CAN_FRAME &frame) { return Can0.inject(frame); }
+
+/**
+ * @brief Takes the oldest frame the VCU transmitted on Can0.
+ * @return False if nothing was sent.
+ */
+inline bool can_pop_sent(CAN_FRAME &frame) { return Can0.pop_sent(frame); }
+
+/**
+ * @brief When enabled, frames the VCU sends are also received back through
+ * the filters (a bus with an echoing node). Default: off.
+ */
+inline void set_can_loopback(bool enable) { Can0.set_loopback(enable); }
+
+/**
+ * @brief Holds the TX mailbox busy (as on a saturated bus) so frames stay in
+ * the VCU's software queue.
+ */
+inline void set_can_tx_busy(bool busy) { Can0.set_tx_busy(busy); }
+
+} // namespace native_hal
+
+#endif // NATIVE_HAL_H
@@ -0,0 +1,251 @@
+/**
+ * @file adc_sampler.cpp
+ * @brief Implements free-running, DMA-driven ADC sampling and the
+ * median/oversample/decimate filter for the APPS and brake pressure channels
+ * (see adc_sampler.h). Host builds fill the same buffers from analogRead() so
+ * the filter and control code run unchanged on the native HAL.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "adc_sampler.h"
+#include "header.h"
+#include <atomic> // For std::atomic_signal_fence (ISR ordering)
+
+#define ADC_BUFFER_SAMPLES (ADC_OVERSAMPLE_FACTOR * ADC_SAMPLER_NUM_CHANNELS)
+
+static_assert(ADC_OVERSAMPLE_FACTOR >= 1 && ADC_OVERSAMPLE_FACTOR <= 1024,
+              "ADC_OVERSAMPLE_FACTOR out of range");
+static_assert(ADC_SAMPLER_MAX_AGE_US <= 5000,
+              "ADC filter latency too high for the 1 kHz torque loop");
+
+// Order of the values in published_values / AdcSnapshot
+static const uint32_t sampler_pins[ADC_SAMPLER_NUM_CHANNELS] = {
+    APPS_1_PIN, APPS_2_PIN, BRAKE_PRESSURE_SENSOR_PIN};
+
+// Latest filtered output, written by the ADC interrupt. published_sequence is
+// odd while the interrupt is writing, and changes with every output (seqlock).
+static volatile uint32_t published_sequence = 0;
+static volatile uint16_t published_values[ADC_SAMPLER_NUM_CHANNELS];
+static volatile uint32_t published_time_us = 0;
+static volatile uint32_t overrun_count = 0;
+static bool sampler_started = false;
+
+// Sample tag (ADC channel number, bits 15:12) -> index in published_values
+static int8_t channel_slot[16];
+
+static void publish_output(const uint16_t *values) {
+  uint32_t sequence = published_sequence;
+  published_sequence = sequence + 1; // Odd: write in progress
+  std::atomic_signal_fence(std::memory_order_release);
+  for (uint8_t i = 0; i < ADC_SAMPLER_NUM_CHANNELS; i++) {
+    published_values[i] = values[i];
+  }
+  published_time_us = micros();
+  std::atomic_signal_fence(std::memory_order_release);
+  published_sequence = sequence + 2; // Even: output complete
+}
+
+//------------------------------------------------------------------------------
+// Median / Oversample / Decimate Filter
+//------------------------------------------------------------------------------
+#if ADC_MEDIAN_REJECTION
+// Last two raw samples per channel, carried across buffers
+static uint16_t median_history[ADC_SAMPLER_NUM_CHANNELS][2];
+static bool median_primed[ADC_SAMPLER_NUM_CHANNELS];
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+  uint16_t lo = a < b ? a : b;
+  uint16_t hi = a < b ? b : a;
+  return c < lo ? lo : (c > hi ? hi : c);
+}
+#endif
+
+/**
+ * @brief Filters one buffer of interleaved, tagged samples down to one
+ * 16-bit value per channel. Runs in the ADC interrupt: ~15 cycles per
+ * sample, ~0.7k cycles per buffer at the default factor of 16.
+ * @return False if a sample carries an unexpected tag or the buffer does not
+ * hold exactly ADC_OVERSAMPLE_FACTOR samples of every channel; values are
+ * then untouched.
+ */
+static bool decimate_buffer(const uint16_t *buffer, uint16_t *values) {
+  uint32_t sums[ADC_SAMPLER_NUM_CHANNELS] = {0};
+  uint16_t counts[ADC_SAMPLER_NUM_CHANNELS] = {0};
+
+  for (uint16_t k = 0; k < ADC_BUFFER_SAMPLES; k++) {
+    int8_t slot = channel_slot[buffer[k] >> 12];
+    if (slot < 0)
+      return false;
+    uint16_t sample = buffer[k] & 0x0FFF;
+#if ADC_MEDIAN_REJECTION
+    uint16_t *history = median_history[slot];
+    if (!median_primed[slot]) {
+      history[0] = history[1] = sample;
+      median_primed[slot] = true;
+    }
+    uint16_t filtered = median3(history[0], history[1], sample);
+    history[0] = history[1];
+    history[1] = sample;
+    sample = filtered;
+#endif
+    sums[slot] += sample;
+    counts[slot]++;
+  }
+
+  for (uint8_t i = 0; i < ADC_SAMPLER_NUM_CHANNELS; i++) {
+    if (counts[i] != ADC_OVERSAMPLE_FACTOR)
+      return false;
+    // Mean scaled to 16 bits; a constant divisor (a shift for powers of 2)
+    values[i] = (uint16_t)((sums[i] << ADC_SAMPLER_OUTPUT_SHIFT) /
+                           ADC_OVERSAMPLE_FACTOR);
+  }
+  return true;
+}
+
+#if defined(ARDUINO_ARCH_SAM)
+//------------------------------------------------------------------------------
+// SAM3X: Free-Running Scan + PDC Double Buffer
+//------------------------------------------------------------------------------
+// The PDC fills dma_buffers[dma_active] while dma_buffers[dma_active ^ 1] is
+// queued as the next buffer. On ENDRX the PDC has already switched to the
+// queued buffer, so the completed one is stable for a whole buffer period.
+static uint16_t dma_buffers[2][ADC_BUFFER_SAMPLES];
+static volatile uint8_t dma_active = 0;
+
+bool adc_sampler_begin() {
+  uint32_t channel_mask = 0;
+  for (uint8_t ch = 0; ch < 16; ch++) {
+    channel_slot[ch] = -1;
+  }
+  for (uint8_t i = 0; i < ADC_SAMPLER_NUM_CHANNELS; i++) {
+    uint32_t ch = g_APinDescription[sampler_pins[i]].ulADCChannelNumber;
+    if (ch > 15 || channel_slot[ch] >= 0) {
+      if (DEBUG_MODE) {
+        Serial.print("ADC Sampler: Pin is not a unique ADC channel: ");
+        Serial.println(sampler_pins[i]);
+      }
+      return false;
+    }
+    channel_slot[ch] = i;
+    channel_mask |= 1u << ch;
+  }
+
+  pmc_enable_periph_clk(ID_ADC);
+  NVIC_DisableIRQ(ADC_IRQn);
+  ADC->ADC_PTCR = ADC_PTCR_RXTDIS | ADC_PTCR_TXTDIS;
+  ADC->ADC_CR = ADC_CR_SWRST;
+
+  // 12-bit, free running, channels converted in ascending order. TAG puts
+  // the channel number in bits 15:12 of each sample so the filter can map
+  // samples without assuming the sequence.
+  ADC->ADC_MR = ADC_MR_FREERUN_ON | ADC_MR_PRESCAL(ADC_SAMPLER_PRESCAL) |
+                ADC_MR_STARTUP_SUT64 | ADC_MR_SETTLING_AST3 |
+                ADC_MR_TRACKTIM(0) | ADC_MR_TRANSFER(1);
+  ADC->ADC_EMR = ADC_EMR_TAG;
+  ADC->ADC_CHDR = 0xFFFF;
+  ADC->ADC_CHER = channel_mask;
+  ADC->ADC_IDR = 0xFFFFFFFF;
+
+  dma_active = 0;
+  ADC->ADC_RPR = (uint32_t)dma_buffers[0];
+  ADC->ADC_RCR = ADC_BUFFER_SAMPLES;
+  ADC->ADC_RNPR = (uint32_t)dma_buffers[1];
+  ADC->ADC_RNCR = ADC_BUFFER_SAMPLES;
+  ADC->ADC_PTCR = ADC_PTCR_RXTEN;
+
+  ADC->ADC_IER = ADC_IER_ENDRX;
+  NVIC_ClearPendingIRQ(ADC_IRQn);
+  NVIC_EnableIRQ(ADC_IRQn);
+  ADC->ADC_CR = ADC_CR_START;
+
+  sampler_started = true;
+  if (DEBUG_MODE) {
+    Serial.print("ADC Sampler: Free-running 12-bit scan with DMA started, ");
+    Serial.print(ADC_OVERSAMPLE_FACTOR);
+    Serial.print("x oversampling, ~");
+    Serial.print(ADC_SAMPLER_OUTPUT_RATE_HZ);
+    Serial.println(" Hz output.");
+  }
+  return true;
+}
+
+void ADC_Handler() {
+  uint32_t status = ADC->ADC_ISR; // Reading clears GOVRE
+  if (!(status & ADC_ISR_ENDRX))
+    return;
+
+  // Requeue the completed buffer behind the one the PDC is now filling
+  uint8_t completed = dma_active;
+  dma_active = completed ^ 1;
+  ADC->ADC_RNPR = (uint32_t)dma_buffers[completed];
+  ADC->ADC_RNCR = ADC_BUFFER_SAMPLES;
+
+  if (status & ADC_ISR_GOVRE) {
+    overrun_count++;
+  }
+
+  uint16_t values[ADC_SAMPLER_NUM_CHANNELS];
+  if (!decimate_buffer(dma_buffers[completed], values)) {
+    overrun_count++; // Corrupt buffer; keep the previous output
+    return;
+  }
+  publish_output(values);
+}
+
+#else // Host build
+//------------------------------------------------------------------------------
+// Host: analogRead() on demand
+//------------------------------------------------------------------------------
+bool adc_sampler_begin() {
+  for (uint8_t ch = 0; ch < 16; ch++) {
+    channel_slot[ch] = ch < ADC_SAMPLER_NUM_CHANNELS ? (int8_t)ch : -1;
+  }
+  analogReadResolution(ADC_SAMPLER_BITS);
+  sampler_started = true;
+  return true;
+}
+
+// Stands in for the DMA and interrupt: one fresh buffer per read, tagged with
+// the slot number as the channel
+static void sample_now() {
+  uint16_t buffer[ADC_BUFFER_SAMPLES];
+  for (uint16_t k = 0; k < ADC_BUFFER_SAMPLES; k++) {
+    uint8_t slot = k % ADC_SAMPLER_NUM_CHANNELS;
+    buffer[k] = (uint16_t)((slot << 12) |
+                           (analogRead(sampler_pins[slot]) & 0x0FFF));
+  }
+  uint16_t values[ADC_SAMPLER_NUM_CHANNELS];
+  if (decimate_buffer(buffer, values)) {
+    publish_output(values);
+  } else {
+    overrun_count++;
+  }
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Snapshot Access
+//------------------------------------------------------------------------------
+bool adc_sampler_read(AdcSnapshot &snapshot) {
+#if !defined(ARDUINO_ARCH_SAM)
+  if (sampler_started)
+    sample_now();
+#endif
+  uint32_t before, after;
+  do {
+    before = published_sequence;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    snapshot.apps_1 = published_values[0];
+    snapshot.apps_2 = published_values[1];
+    snapshot.brake_pressure = published_values[2];
+    snapshot.timestamp_us = published_time_us;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    after = published_sequence;
+  } while ((before & 1) || before != after);
+
+  snapshot.sequence = before >> 1;
+  return sampler_started && snapshot.sequence != 0;
+}
+
+uint32_t adc_sampler_get_overrun_count() { return overrun_count; }
@@ -10,24 +10,44 @@
 // - Accurately calibrate PEDAL_VOLTAGE_MIN and PEDAL_VOLTAGE_MAX by measuring
 //   the actual voltage output from each APPS sensor at 0% and 100% pedal
 //   travel.
-// - Verify ADC_MAX_VALUE and ADC_REF_VOLTAGE match the Arduino Due's
-// configuration
-//   (Due default is 10-bit ADC (0-1023) with 3.3V reference, but can be
-//   changed).
+// - Verify ADC_REF_VOLTAGE matches the Arduino Due's configuration (3.3V
+//   reference). Samples come from adc_sampler (filtered, 16-bit scale,
+//   0-ADC_SAMPLER_MAX_VALUE).
 
 #include "header.h"
+#include "logger.h"
 #include <cmath>  // For std::fabs
 #include <limits> // For std::numeric_limits
 
 // Define pedal calibration constants here (as they are specific to this file)
 // TODO: These values MUST be calibrated on the actual vehicle.
-const double PEDAL_VOLTAGE_MIN = 1.4; // Voltage at 0% pedal travel - CALIBRATE!
-const double PEDAL_VOLTAGE_MAX =
+constexpr double PEDAL_VOLTAGE_MIN =
+    1.4; // Voltage at 0% pedal travel - CALIBRATE!
+constexpr double PEDAL_VOLTAGE_MAX =
     3.2; // Voltage at 100% pedal travel - CALIBRATE!
-// TODO: Verify ADC settings for Arduino Due (default 10-bit, 3.3V ref)
-const double ADC_MAX_VALUE =
-    1023.0; // Max value for Arduino Due's 10-bit ADC (use 4095 for 12-bit)
-const double ADC_REF_VOLTAGE = 3.3; // ADC reference voltage
+// TODO: Verify ADC reference for Arduino Due (3.3V)
+constexpr double ADC_MAX_VALUE =
+    ADC_SAMPLER_MAX_VALUE; // Full scale of adc_sampler values (16-bit)
+constexpr double ADC_REF_VOLTAGE = 3.3; // ADC reference voltage
+
+// Integer calibration for get_apps_reading_q15(), derived from the constants
+// above at compile time: pedal_q15 = (raw * GAIN - OFFSET) >> SHIFT.
+// SHIFT keeps raw * GAIN inside int32_t for 16-bit input while leaving GAIN
+// precise to ~1e-6, so the result is within 1 LSB of the double path.
+#define APPS_Q15_SHIFT 14
+constexpr double APPS_COUNTS_MIN =
+    PEDAL_VOLTAGE_MIN * ADC_MAX_VALUE / ADC_REF_VOLTAGE;
+constexpr double APPS_COUNTS_RANGE =
+    (PEDAL_VOLTAGE_MAX - PEDAL_VOLTAGE_MIN) * ADC_MAX_VALUE / ADC_REF_VOLTAGE;
+static_assert(APPS_COUNTS_RANGE >= 1.0,
+              "PEDAL_VOLTAGE_MAX must exceed PEDAL_VOLTAGE_MIN. Check "
+              "Calibration.");
+constexpr int32_t APPS_Q15_GAIN =
+    (int32_t)(32768.0 * (1 << APPS_Q15_SHIFT) / APPS_COUNTS_RANGE + 0.5);
+constexpr int32_t APPS_Q15_OFFSET =
+    (int32_t)(APPS_COUNTS_MIN * APPS_Q15_GAIN + 0.5);
+static_assert(ADC_MAX_VALUE * APPS_Q15_GAIN < 2147483647.0,
+              "APPS_Q15_SHIFT too large for the ADC resolution");
 
 // Export constants needed elsewhere (e.g., potentially for dashboard display)
 // These are defined above, extern declaration allows other files to see them.
@@ -38,12 +58,17 @@ const double ADC_REF_VOLTAGE = 3.3; // ADC reference voltage
 /**
  * @brief Reads the two APPS sensors, checks for plausibility, and returns the
  * average pedal position as a percentage (0-100).
+ * Floating-point reference implementation; the control loop uses
+ * get_apps_reading_q15(). The bench compares the two.
  * @return Pedal position (0.0 to 100.0) if sensors are plausible,
  * -1.0 if an implausibility is detected according to FSUK EV.5.6.
  */
 double get_apps_reading() {
-  int apps_1_raw = analogRead(APPS_1_PIN);
-  int apps_2_raw = analogRead(APPS_2_PIN);
+  AdcSnapshot adc;
+  if (!adc_sampler_read(adc))
+    return -1.0; // No sample yet: treat as implausible
+  int apps_1_raw = adc.apps_1;
+  int apps_2_raw = adc.apps_2;
 
   // 1. Convert raw ADC values to voltages
   double apps_1_voltage = apps_1_raw * ADC_REF_VOLTAGE / ADC_MAX_VALUE;
@@ -53,7 +78,7 @@ double get_apps_reading() {
   // Ensure denominator is not zero
   double pedal_range = PEDAL_VOLTAGE_MAX - PEDAL_VOLTAGE_MIN;
   if (std::fabs(pedal_range) < std::numeric_limits<double>::epsilon()) {
-    if (DEBUG_MODE) {
+    if (debug_enabled()) {
       Serial.println("APPS Error: PEDAL_VOLTAGE_MAX == PEDAL_VOLTAGE_MIN! "
                      "Check Calibration.");
     }
@@ -73,7 +98,7 @@ double get_apps_reading() {
   // Compare the calculated percentages.
   if (std::fabs(apps_1_percent - apps_2_percent) >
       APPS_PLAUSIBILITY_THRESHOLD) {
-    if (DEBUG_MODE) {
+    if (debug_enabled()) {
       Serial.print("APPS Implausibility Detected! APPS1: ");
       Serial.print(apps_1_percent);
       Serial.print("%, APPS2: ");
@@ -89,7 +114,7 @@ double get_apps_reading() {
   // 4. Return the average percentage if plausible
   double average_percent = (apps_1_percent + apps_2_percent) / 2.0;
 
-  if (DEBUG_MODE >= 2) { // Add higher debug level if needed
+  if (debug_enabled(2)) { // Add higher debug level if needed
     Serial.print("APPS Readings - Raw: ");
     Serial.print(apps_1_raw);
     Serial.print(", ");
@@ -108,3 +133,59 @@ double get_apps_reading() {
 
   return average_percent;
 }
+
+//------------------------------------------------------------------------------
+// Fixed-Point APPS Reading
+//------------------------------------------------------------------------------
+// Raw ADC counts -> Q15 pedal fraction, clamped to [0, Q15_ONE]
+static inline q15_t apps_counts_to_q15(int32_t raw) {
+  int32_t value = (raw * APPS_Q15_GAIN - APPS_Q15_OFFSET) >> APPS_Q15_SHIFT;
+  if (value < 0)
+    return 0;
+  if (value > Q15_ONE)
+    return Q15_ONE;
+  return (q15_t)value;
+}
+
+/**
+ * @brief Integer equivalent of get_apps_reading() for the control loop. Same
+ * calibration and plausibility semantics, no floating point (the SAM3X8E has
+ * no FPU).
+ * @param adc Scan to evaluate; both sensors come from the same scan.
+ * @return Average pedal position as a Q15 fraction (0 to Q15_ONE) if the
+ * sensors are plausible, -1 if an implausibility is detected (FSUK EV.5.6).
+ */
+q15_t get_apps_reading_q15(const AdcSnapshot &adc) {
+  int32_t apps_1_raw = adc.apps_1;
+  int32_t apps_2_raw = adc.apps_2;
+
+  q15_t apps_1_q15 = apps_counts_to_q15(apps_1_raw);
+  q15_t apps_2_q15 = apps_counts_to_q15(apps_2_raw);
+
+  // Implausibility check (FSUK EV.5.6: deviation > 10%)
+  int32_t deviation = (int32_t)apps_1_q15 - apps_2_q15;
+  if (deviation < 0)
+    deviation = -deviation;
+  if (deviation > APPS_PLAUSIBILITY_THRESHOLD_Q15) {
+    log_event<LOG_APPS_IMPLAUSIBLE>(q15_to_permille(apps_1_q15),
+                                    q15_to_permille(apps_2_q15));
+    return -1; // Indicate implausibility
+  }
+
+  q15_t average_q15 = (q15_t)(((int32_t)apps_1_q15 + apps_2_q15) >> 1);
+
+  log_event<LOG_APPS_READING>(apps_1_raw, apps_2_raw, apps_1_q15, apps_2_q15);
+
+  return average_q15;
+}
+
+/**
+ * @brief get_apps_reading_q15() on the newest ADC scan.
+ * @return As above; -1 if no scan has completed yet.
+ */
+q15_t get_apps_reading_q15() {
+  AdcSnapshot adc;
+  if (!adc_sampler_read(adc))
+    return -1;
+  return get_apps_reading_q15(adc);
+}
@@ -1,25 +1,28 @@
 /**
  * @file bms_handler.cpp
  * @brief Implements the BMSHandler class for processing Orion BMS 2 CAN
- * messages. NOTE: Parsing logic is a placeholder and MUST be updated based on
- * actual BMS configuration and CAN specification.
+ * messages. Frames are decoded by the functions generated from dbc/vcu.dbc
+ * (can_signals.h). NOTE: The DBC layout is a placeholder and MUST be updated
+ * based on actual BMS configuration and CAN specification.
  * @author Shane Whelan (UCD Formula Student)
  * @date 2025-04-27
  */
 
 // TODO:
-// - Replace ALL placeholder parsing logic in parse_bms_message_X functions
-//   with the correct decoding (byte order, data types, scaling, offsets)
-//   based on your specific Orion BMS 2 configuration and CAN documentation.
+// - Replace the placeholder layouts in dbc/vcu.dbc (byte order, data types,
+//   scaling, offsets) with your Orion BMS 2 configuration's CAN export and
+//   regenerate can_signals.h (python3 tools/dbc_codegen.py).
 // - Implement the has_critical_fault() function based on the actual fault
 //   flags and critical limits defined by the BMS and FSUK rules.
 // - Add parsing functions for all required BMS message IDs.
 // - Initialize BMSData struct in the constructor with appropriate defaults.
 
 #include "bms_handler.h"
-#include "can_manager.h" // Include CAN manager for IDs if needed
+#include "can_manager.h" // For CANManager::register_rx_handler()
 #include "header.h"      // For DEBUG_MODE, Serial
+#include "logger.h"      // Binary event log (non-blocking)
 #include <Arduino.h>     // For millis()
+#include <string.h>      // For memset
 
 // Define the global instance
 BMSHandler bms_handler;
@@ -30,59 +33,90 @@ BMSHandler bms_handler;
 BMSHandler::BMSHandler() {
   // Initialize BMS data structure with default/safe values
   // TODO: Review these default values
-  current_bms_data.pack_soc = 0.0f;
-  current_bms_data.pack_voltage = 0.0f;
-  current_bms_data.pack_current = 0.0f;
-  current_bms_data.relay_state_ok = false; // Assume relays are not OK initially
-  current_bms_data.discharge_current_limit =
-      0.0f; // Default to no discharge allowed
-  current_bms_data.charge_current_limit = 0.0f; // Default to no charge allowed
-  current_bms_data.high_cell_voltage = 0.0f;
-  current_bms_data.low_cell_voltage =
-      5.0f; // Init low voltage high to avoid false positives
-  current_bms_data.avg_cell_voltage = 0.0f;
-  current_bms_data.high_temperature = -127;
-  current_bms_data.low_temperature = 127; // Init low temp high
-  current_bms_data.avg_temperature = 0;
-  current_bms_data.voltage_fault =
-      true; // Default to fault state until proven otherwise
-  current_bms_data.temperature_fault = true;
-  current_bms_data.communication_fault = true;
-  current_bms_data.charge_interlock_fault = true;
-  current_bms_data.general_fault_code = 0xFFFF; // Example fault code
-  current_bms_data.last_message_millis = 0;
+  working.pack_soc = 0.0f;
+  working.pack_voltage = 0.0f;
+  working.pack_current = 0.0f;
+  working.relay_state_ok = false; // Assume relays are not OK initially
+  working.discharge_current_limit = 0.0f; // Default to no discharge allowed
+  working.charge_current_limit = 0.0f; // Default to no charge allowed
+  working.high_cell_voltage = 0.0f;
+  working.low_cell_voltage = 5.0f; // Init low voltage high to avoid false
+                                   // positives
+  working.avg_cell_voltage = 0.0f;
+  working.high_temperature = -127;
+  working.low_temperature = 127; // Init low temp high
+  working.avg_temperature = 0;
+  working.voltage_fault = true; // Default to fault state until proven
+                                // otherwise
+  working.temperature_fault = true;
+  working.communication_fault = true;
+  working.charge_interlock_fault = true;
+  working.general_fault_code = 0xFFFF; // Example fault code
+  working.last_message_millis = 0;
+  working.generation = 0;
+
+  // No cells reported yet: summary reads 0 with cells_reported = 0
+  memset(cell_resistance, 0, sizeof(cell_resistance));
+  memset(shunting_bits, 0, sizeof(shunting_bits));
+  shunting_count = 0;
+  update_cell_summary();
+
+  // Generation 0, front buffer 0
+  buffers[0] = working;
+  buffers[1] = working;
+  state = 0;
+}
+
+//------------------------------------------------------------------------------
+// Register CAN Handlers
+//------------------------------------------------------------------------------
+bool BMSHandler::register_can_handlers(CANManager &can) {
+  // One row per BMS message ID. Adding a new Orion broadcast means adding its
+  // ID, a parse function and a row here; filters and dispatch follow.
+  static const struct {
+    uint32_t id;
+    bool extended;
+    CanRxHandler handler;
+  } routes[] = {
+      {ORION_BMS_ID_1, can_signals::OrionPack1::EXTENDED,
+       &BMSHandler::rx_trampoline<&BMSHandler::parse_bms_message_1>},
+      {ORION_BMS_ID_2, can_signals::OrionPack2::EXTENDED,
+       &BMSHandler::rx_trampoline<&BMSHandler::parse_bms_message_2>},
+      {ORION_CELL_BROADCAST_ID, can_signals::OrionCellBroadcast::EXTENDED,
+       &BMSHandler::rx_trampoline<&BMSHandler::parse_cell_broadcast>},
+      {ORION_THERMISTOR_BROADCAST_ID,
+       can_signals::OrionThermistorBroadcast::EXTENDED,
+       &BMSHandler::rx_trampoline<&BMSHandler::parse_thermistor_broadcast>},
+      // TODO: Add rows for other BMS message IDs here...
+  };
+
+  bool success = true;
+  for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++) {
+    if (!can.register_rx_handler(routes[i].id, routes[i].handler, this,
+                                 routes[i].extended))
+      success = false;
+  }
+  return success;
 }
 
 //------------------------------------------------------------------------------
 // Handle Incoming Frame
 //------------------------------------------------------------------------------
-void BMSHandler::handle_incoming_frame(const CAN_FRAME &frame) {
+template <void (BMSHandler::*Parse)(const CAN_FRAME &)>
+void BMSHandler::rx_trampoline(const CAN_FRAME &frame, void *context) {
+  BMSHandler *self = static_cast<BMSHandler *>(context);
+
   // Update timestamp for communication health check
-  current_bms_data.last_message_millis = millis();
-  current_bms_data.communication_fault = false; // We received something
-
-  // Call the appropriate parsing function based on ID
-  switch (frame.id) {
-  // TODO: Replace example IDs with actual configured IDs
-  case ORION_BMS_ID_1: // Example ID 0x420
-    parse_bms_message_1(frame);
-    break;
-
-  case ORION_BMS_ID_2: // Example ID 0x421
-    parse_bms_message_2(frame);
-    break;
-
-    // TODO: Add cases for other BMS message IDs here...
-
-  default:
-    // Should not happen if filters are set correctly, but handle defensively
-    if (DEBUG_MODE) {
-      Serial.print("BMSHandler: Received unexpected ID: 0x");
-      Serial.println(frame.id, HEX);
-    }
-    break;
-  }
+  self->working.last_message_millis = millis();
+  self->working.communication_fault = false; // We received something
+
+  (self->*Parse)(frame);
+
+  self->update_fault_flags();
+  self->publish();
+}
 
+void BMSHandler::update_fault_flags() {
   // After parsing, update overall fault status (example)
   // TODO: Implement your actual fault logic based on parsed data & BMS fault
   // codes Example thresholds - ADJUST THESE based on cell datasheet & safety
@@ -91,24 +125,58 @@ void BMSHandler::handle_incoming_frame(const CAN_FRAME &frame) {
   const float MAX_CELL_VOLTAGE = 4.2f;
   const int8_t MAX_CELL_TEMP =
       60; // FSUK Rule EV5.8.5 limit or datasheet, whichever is lower
-
-  current_bms_data.voltage_fault =
-      (current_bms_data.low_cell_voltage < MIN_CELL_VOLTAGE ||
-       current_bms_data.high_cell_voltage > MAX_CELL_VOLTAGE);
-  current_bms_data.temperature_fault =
-      (current_bms_data.high_temperature > MAX_CELL_TEMP);
+  const uint16_t MIN_CELL_MV = (uint16_t)(MIN_CELL_VOLTAGE * 1000);
+  const uint16_t MAX_CELL_MV = (uint16_t)(MAX_CELL_VOLTAGE * 1000);
+
+  // Pack broadcast extremes, then the per-cell model once cells report
+  working.voltage_fault = (working.low_cell_voltage < MIN_CELL_VOLTAGE ||
+                           working.high_cell_voltage > MAX_CELL_VOLTAGE) ||
+                          (working.cells_reported > 0 &&
+                           (working.cell_min_mv < MIN_CELL_MV ||
+                            working.cell_max_mv > MAX_CELL_MV));
+  working.temperature_fault =
+      (working.high_temperature > MAX_CELL_TEMP) ||
+      (working.thermistors_reported > 0 &&
+       working.thermistor_max_c > MAX_CELL_TEMP);
   // Update other fault flags based on specific BMS fault codes received...
 }
 
 //------------------------------------------------------------------------------
-// Get BMS Data
+// Snapshot Publish / Read
 //------------------------------------------------------------------------------
-const BMSData &BMSHandler::get_bms_data() const { return current_bms_data; }
+void BMSHandler::publish() {
+  uint32_t current = state;
+  uint32_t back = (current & 1u) ^ 1u;
+  uint32_t generation = (current >> 1) + 1;
+  working.generation = generation;
+  buffers[back] = working;
+  compiler_barrier(); // Buffer complete before it becomes the front
+  state = (generation << 1) | back;
+}
+
+bool BMSHandler::read_snapshot(BMSData &snapshot) const {
+  for (uint8_t attempt = 0; attempt < BMS_SNAPSHOT_MAX_TRIES; attempt++) {
+    uint32_t before = state;
+    compiler_barrier();
+    snapshot = buffers[before & 1u];
+    compiler_barrier();
+    // The front buffer is only rewritten after a publish moves it to the
+    // back, so an unchanged state word means the copy was not torn
+    if (state == before)
+      return true;
+  }
+  return false;
+}
 
 //------------------------------------------------------------------------------
 // Check for Critical Faults
 //------------------------------------------------------------------------------
 bool BMSHandler::has_critical_fault() const {
+  BMSData snapshot;
+  return !read_snapshot(snapshot) || has_critical_fault(snapshot);
+}
+
+bool BMSHandler::has_critical_fault(const BMSData &data) {
   // TODO: Implement ACTUAL critical fault checking logic.
   // This should check flags set during parsing based on BMS fault codes
   // and critical operating limits (voltage, temp, current limits, relay state).
@@ -118,23 +186,23 @@ bool BMSHandler::has_critical_fault() const {
   // open SDC (handled by comms timeout check).
 
   // Example placeholder logic:
-  if (current_bms_data.communication_fault)
+  if (data.communication_fault)
     return true; // Treat comms loss as critical
-  if (current_bms_data.voltage_fault)
+  if (data.voltage_fault)
     return true;
-  if (current_bms_data.temperature_fault)
+  if (data.temperature_fault)
     return true;
-  if (current_bms_data.charge_interlock_fault)
+  if (data.charge_interlock_fault)
     return true; // Example
-  if (current_bms_data.general_fault_code != 0)
+  if (data.general_fault_code != 0)
     return true; // Check specific critical fault codes from BMS
-  if (!current_bms_data.relay_state_ok)
+  if (!data.relay_state_ok)
     return true; // If relays are commanded open by BMS
 
   // Check against discharge current limit (DCL)
   // Note: Pack current is often negative for charge, positive for discharge
-  if (current_bms_data.pack_current >
-      current_bms_data.discharge_current_limit) {
+  if (data.pack_current >
+      data.discharge_current_limit) {
     // Add a small tolerance if needed
     // return true; // Uncomment if exceeding DCL is considered critical here
   }
@@ -146,112 +214,145 @@ bool BMSHandler::has_critical_fault() const {
 // Check Communication Activity
 //------------------------------------------------------------------------------
 bool BMSHandler::is_communication_active(unsigned long timeout_ms) const {
-  if (current_bms_data.last_message_millis == 0 && millis() > timeout_ms) {
+  // One word of the front buffer: no snapshot needed
+  unsigned long last_message_millis = buffers[state & 1u].last_message_millis;
+  if (last_message_millis == 0 && millis() > timeout_ms) {
     // If we haven't received *any* messages after the timeout period, assume
     // comms failure
     return false;
   }
   // If we have received messages, check if the last one was within the timeout
   // period
-  return (millis() - current_bms_data.last_message_millis) < timeout_ms;
+  return (millis() - last_message_millis) < timeout_ms;
 }
 
 //------------------------------------------------------------------------------
-// Placeholder Parsing Functions - *** REPLACE WITH ACTUAL IMPLEMENTATION ***
+// Periodic Supervision
 //------------------------------------------------------------------------------
+void BMSHandler::update_supervision(unsigned long timeout_ms) {
+  if (working.communication_fault || is_communication_active(timeout_ms))
+    return;
+  {
+    // The CAN RX path owns working and may run in the torque interrupt;
+    // re-check under the lock in case a frame arrived meanwhile
+    CriticalSection lock;
+    if (is_communication_active(timeout_ms))
+      return;
+    working.communication_fault = true;
+    publish();
+  }
+  log_event<LOG_BMS_COMM_TIMEOUT>();
+}
+
+//------------------------------------------------------------------------------
+// Pack Broadcasts
+//------------------------------------------------------------------------------
+// Layouts come from dbc/vcu.dbc through the generated decoders in
+// can_signals.h; the DBC still holds the placeholder Orion layout.
 
-// TODO: Implement actual parsing based on your Orion BMS CAN Spec
 void BMSHandler::parse_bms_message_1(const CAN_FRAME &frame) {
-  // --- Placeholder for ID 0x420 (Example based on search result snippet) ---
-  // WARNING: Actual Orion BMS 2 CAN spec needed for correct byte order,
-  //          scaling, offsets, and data types (int vs uint, float
-  //          representation).
-  // This example assumes Little Endian and simple scaling/no offsets.
-
-  if (frame.length == 8) { // Check data length code
-    // Example: Pack SOC (byte 0, uint8, scale 0.5, offset 0 -> range 0-127.5%)
-    // TODO: Verify scaling and offset from BMS Tool
-    current_bms_data.pack_soc = (float)frame.data.bytes[0] * 0.5f;
-
-    // Example: Pack DCL (Discharge Current Limit) (bytes 1-2, uint16, scale 1,
-    // offset 0) Assuming Little Endian: LSB = byte 1, MSB = byte 2
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_dcl = frame.data.bytes[1] | (frame.data.bytes[2] << 8);
-    current_bms_data.discharge_current_limit =
-        (float)raw_dcl; // Apply scaling/offset if needed
-
-    // Example: High Cell Voltage (bytes 4-5, uint16, scale 0.0001, offset 0)
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_high_v = frame.data.bytes[4] | (frame.data.bytes[5] << 8);
-    current_bms_data.high_cell_voltage = (float)raw_high_v * 0.0001f;
-
-    // Example: Low Cell Voltage (bytes 6-7, uint16, scale 0.0001, offset 0)
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_low_v = frame.data.bytes[6] | (frame.data.bytes[7] << 8);
-    current_bms_data.low_cell_voltage = (float)raw_low_v * 0.0001f;
-
-    // TODO: Parse other fields from this ID (State of Health, High/Avg Temp
-    // etc.) Example: High Temp (byte 2, int8, scale 1, offset 0)
-    // TODO: Verify byte order, scaling, offset
-    current_bms_data.high_temperature =
-        (int8_t)frame.data.bytes[2]; // Cast needed for signed
-
-    // TODO: Parse BMS Relay Status (often part of a status/flags byte/word)
-    // Example: current_bms_data.relay_state_ok =
-    // check_relay_status_bits(frame.data.bytes[X]);
-
-    // TODO: Parse BMS Fault Codes (often part of a status/flags byte/word)
-    // Example: current_bms_data.general_fault_code =
-    // get_fault_code(frame.data.bytes[Y], frame.data.bytes[Z]);
-
-  } else {
-    if (DEBUG_MODE) {
-      Serial.print("BMSHandler: Incorrect DLC for ID 0x");
-      Serial.print(frame.id, HEX);
-      Serial.print(", expected 8, got ");
-      Serial.println(frame.length);
-    }
+  typedef can_signals::OrionPack1 Msg;
+  if (frame.length != Msg::DLC) {
+    log_event<LOG_BMS_BAD_DLC>(frame.id, frame.length);
+    return;
   }
+  const uint8_t *d = frame.data.bytes;
+  working.pack_soc = Msg::pack_soc(d);
+  working.discharge_current_limit = (float)Msg::pack_dcl(d);
+  working.high_cell_voltage = Msg::high_cell_voltage(d);
+  working.low_cell_voltage = Msg::low_cell_voltage(d);
+  working.high_temperature = Msg::high_temperature(d);
+
+  // TODO: Parse BMS Relay Status and Fault Codes once the DBC has them
+  // (working.relay_state_ok, working.general_fault_code)
 }
 
-// TODO: Implement actual parsing based on your Orion BMS CAN Spec
 void BMSHandler::parse_bms_message_2(const CAN_FRAME &frame) {
-  // --- Placeholder for ID 0x421 (Example based on search result snippet) ---
-  // WARNING: Actual Orion BMS 2 CAN spec needed.
-
-  if (frame.length == 8) { // Check data length code
-    // Example: Pack CCL (Charge Current Limit) (bytes 0-1, uint16, scale 1,
-    // offset 0)
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_ccl = frame.data.bytes[0] | (frame.data.bytes[1] << 8);
-    current_bms_data.charge_current_limit = (float)raw_ccl;
-
-    // Example: Pack Voltage (bytes 2-3, uint16, scale 0.1, offset 0)
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_pack_v = frame.data.bytes[2] | (frame.data.bytes[3] << 8);
-    current_bms_data.pack_voltage = (float)raw_pack_v * 0.1f;
-
-    // Example: Pack Current (bytes 4-5, int16, scale 0.1, offset 0)
-    // Note: int16 for signed current
-    // TODO: Verify byte order, scaling, offset, sign convention
-    int16_t raw_pack_c = frame.data.bytes[4] | (frame.data.bytes[5] << 8);
-    current_bms_data.pack_current = (float)raw_pack_c * 0.1f;
-
-    // Example: Average Cell Voltage (bytes 6-7, uint16, scale 0.0001, offset 0)
-    // TODO: Verify byte order, scaling, offset
-    uint16_t raw_avg_v = frame.data.bytes[6] | (frame.data.bytes[7] << 8);
-    current_bms_data.avg_cell_voltage = (float)raw_avg_v * 0.0001f;
-
-    // TODO: Parse other fields from this ID...
-
-  } else {
-    if (DEBUG_MODE) {
-      Serial.print("BMSHandler: Incorrect DLC for ID 0x");
-      Serial.print(frame.id, HEX);
-      Serial.print(", expected 8, got ");
-      Serial.println(frame.length);
-    }
+  typedef can_signals::OrionPack2 Msg;
+  if (frame.length != Msg::DLC) {
+    log_event<LOG_BMS_BAD_DLC>(frame.id, frame.length);
+    return;
   }
+  const uint8_t *d = frame.data.bytes;
+  working.charge_current_limit = (float)Msg::pack_ccl(d);
+  working.pack_voltage = Msg::pack_voltage(d);
+  working.pack_current = Msg::pack_current(d);
+  working.avg_cell_voltage = Msg::avg_cell_voltage(d);
 }
 
 // TODO: Add implementations for other parsing functions...
+
+//------------------------------------------------------------------------------
+// Cell-Level Broadcasts
+//------------------------------------------------------------------------------
+void BMSHandler::update_cell_summary() {
+  working.cell_min_mv = cell_mv.min();
+  working.cell_max_mv = cell_mv.max();
+  working.cell_avg_mv = cell_mv.average();
+  working.cell_imbalance_mv = (uint16_t)(cell_mv.max() - cell_mv.min());
+  working.cell_min_id = cell_mv.min_index();
+  working.cell_max_id = cell_mv.max_index();
+  working.cells_reported = (uint8_t)cell_mv.count();
+  working.cells_shunting = shunting_count;
+  working.thermistor_min_c = thermistor_c.min();
+  working.thermistor_max_c = thermistor_c.max();
+  working.thermistor_avg_c = thermistor_c.average();
+  working.thermistor_max_id = thermistor_c.max_index();
+  working.thermistors_reported = (uint8_t)thermistor_c.count();
+}
+
+void BMSHandler::parse_cell_broadcast(const CAN_FRAME &frame) {
+  typedef can_signals::OrionCellBroadcast Msg;
+  if (frame.length != Msg::DLC) {
+    log_event<LOG_BMS_BAD_DLC>(frame.id, frame.length);
+    return;
+  }
+  const uint8_t *d = frame.data.bytes;
+  // Checksum: low byte of ID + length + bytes 0-6
+  uint8_t checksum = (uint8_t)(frame.id + frame.length);
+  for (uint8_t i = 0; i < Msg::CHECKSUM_MIN_DLC - 1; i++)
+    checksum += d[i];
+  if (checksum != Msg::checksum(d)) {
+    log_event<LOG_BMS_BAD_CHECKSUM>(frame.id, Msg::cell_id(d));
+    return;
+  }
+  uint8_t cell = Msg::cell_id(d);
+  if (cell >= BMS_NUM_CELLS) {
+    log_event<LOG_BMS_INDEX_OUT_OF_RANGE>(frame.id, cell);
+    return;
+  }
+
+  // Voltage 0.1 mV -> mV, kept in integers
+  cell_mv.update(cell, (uint16_t)(Msg::cell_voltage_raw(d) / 10));
+  cell_resistance[cell] = Msg::cell_resistance_raw(d);
+
+  uint8_t bit = (uint8_t)(1u << (cell & 7));
+  bool shunting = Msg::cell_shunting(d);
+  if (shunting != ((shunting_bits[cell >> 3] & bit) != 0)) {
+    shunting_bits[cell >> 3] ^= bit;
+    if (shunting) {
+      shunting_count++;
+    } else {
+      shunting_count--;
+    }
+  }
+  update_cell_summary();
+}
+
+void BMSHandler::parse_thermistor_broadcast(const CAN_FRAME &frame) {
+  typedef can_signals::OrionThermistorBroadcast Msg;
+  if (frame.length != Msg::DLC) {
+    log_event<LOG_BMS_BAD_DLC>(frame.id, frame.length);
+    return;
+  }
+  // One thermistor (ID across all modules) per frame; the module's own
+  // min/max in the rest of the frame are not used
+  const uint8_t *d = frame.data.bytes;
+  uint16_t thermistor = Msg::thermistor_id(d);
+  if (thermistor >= BMS_NUM_THERMISTORS) {
+    log_event<LOG_BMS_INDEX_OUT_OF_RANGE>(frame.id, thermistor);
+    return;
+  }
+  thermistor_c.update(thermistor, Msg::thermistor_temperature(d));
+  update_cell_summary();
+}
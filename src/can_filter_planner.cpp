@@ -0,0 +1,162 @@
+/**
+ * @file can_filter_planner.cpp
+ * @brief Implements the greedy ID/mask filter planner used by CANManager to
+ * fit all registered RX IDs into the SAM3X mailboxes.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "can_filter_planner.h"
+
+#define STD_ID_MASK 0x7FFu
+#define EXT_ID_MASK 0x1FFFFFFFu
+#define PLANNER_MAX_GROUPS 32 // Matches CAN_MAX_RX_HANDLERS
+
+// Working filter during planning (standard IDs only)
+typedef struct {
+  uint32_t id;
+  uint32_t mask;
+} WorkFilter;
+
+//------------------------------------------------------------------------------
+// Set Helpers (standard 11-bit IDs)
+//------------------------------------------------------------------------------
+// Number of IDs matched by a mask = 2^(don't-care bits)
+static uint32_t std_set_size(uint32_t mask) {
+  return 1u << (11 - __builtin_popcount(mask & STD_ID_MASK));
+}
+
+// Number of IDs matched by both filters
+static uint32_t std_intersection(uint32_t id_a, uint32_t mask_a, uint32_t id_b,
+                                 uint32_t mask_b) {
+  if ((id_a ^ id_b) & mask_a & mask_b)
+    return 0; // A bit both care about differs: disjoint
+  return std_set_size(mask_a | mask_b);
+}
+
+// True if every ID matched by (id_k, mask_k) is also matched by (id_f, mask_f)
+static bool std_is_subset(uint32_t id_k, uint32_t mask_k, uint32_t id_f,
+                          uint32_t mask_f) {
+  return (mask_f & ~mask_k) == 0 && (id_k & mask_f) == id_f;
+}
+
+// Smallest single filter covering both a and b
+static WorkFilter std_merge(const WorkFilter &a, const WorkFilter &b) {
+  WorkFilter merged;
+  merged.mask = a.mask & b.mask & ~(a.id ^ b.id) & STD_ID_MASK;
+  merged.id = a.id & merged.mask;
+  return merged;
+}
+
+// Wanted IDs inside a filter (groups are disjoint, so intersections add up)
+static uint32_t std_wanted_in(const WorkFilter &f, const CanFilterGroup *groups,
+                              uint8_t group_count) {
+  uint32_t wanted = 0;
+  for (uint8_t g = 0; g < group_count; g++) {
+    if (!groups[g].extended) {
+      wanted += std_intersection(f.id, f.mask, groups[g].id, groups[g].mask);
+    }
+  }
+  return wanted;
+}
+
+//------------------------------------------------------------------------------
+// Plan Filters
+//------------------------------------------------------------------------------
+bool plan_can_filters(const CanFilterGroup *groups, uint8_t group_count,
+                      uint8_t max_filters, CanFilterPlan &plan) {
+  WorkFilter work[PLANNER_MAX_GROUPS];
+  uint8_t work_count = 0;
+  uint8_t ext_count = 0;
+
+  plan.count = 0;
+  plan.total_unwanted = 0;
+
+  if (max_filters > CAN_FILTER_PLAN_MAX)
+    max_filters = CAN_FILTER_PLAN_MAX;
+  if (group_count > PLANNER_MAX_GROUPS)
+    return false;
+
+  for (uint8_t g = 0; g < group_count; g++) {
+    if (groups[g].extended) {
+      ext_count++;
+    } else {
+      work[work_count].mask = groups[g].mask & STD_ID_MASK;
+      work[work_count].id = groups[g].id & work[work_count].mask;
+      work_count++;
+    }
+  }
+  if (ext_count > max_filters)
+    return false;
+  uint8_t std_budget = max_filters - ext_count;
+
+  // Greedy agglomeration: repeatedly apply the cheapest pairwise merge. Cost is
+  // the change in unwanted IDs, counting any other filter the merged one
+  // swallows. Keep going while over budget, or while a free merge exists.
+  while (work_count > 1) {
+    int best_i = -1, best_j = -1;
+    int32_t best_cost = 0;
+    uint32_t best_admitted = 0;
+
+    for (uint8_t i = 0; i < work_count; i++) {
+      for (uint8_t j = i + 1; j < work_count; j++) {
+        WorkFilter merged = std_merge(work[i], work[j]);
+        uint32_t admitted = std_set_size(merged.mask);
+        int32_t cost = (int32_t)(admitted -
+                                 std_wanted_in(merged, groups, group_count));
+        for (uint8_t k = 0; k < work_count; k++) {
+          if (std_is_subset(work[k].id, work[k].mask, merged.id, merged.mask)) {
+            cost -= (int32_t)(std_set_size(work[k].mask) -
+                              std_wanted_in(work[k], groups, group_count));
+          }
+        }
+        if (best_i < 0 || cost < best_cost ||
+            (cost == best_cost && admitted < best_admitted)) {
+          best_i = i;
+          best_j = j;
+          best_cost = cost;
+          best_admitted = admitted;
+        }
+      }
+    }
+
+    if (work_count <= std_budget && best_cost > 0)
+      break; // Fits, and every remaining merge would admit extra traffic
+
+    // Apply the merge: replace i, drop j and anything now covered by i
+    WorkFilter merged = std_merge(work[best_i], work[best_j]);
+    uint8_t kept = 0;
+    for (uint8_t k = 0; k < work_count; k++) {
+      if (!std_is_subset(work[k].id, work[k].mask, merged.id, merged.mask)) {
+        work[kept++] = work[k];
+      }
+    }
+    work[kept++] = merged;
+    work_count = kept;
+  }
+
+  if (work_count > std_budget)
+    return false;
+
+  // Emit: standard filters first, then extended groups as registered
+  for (uint8_t i = 0; i < work_count; i++) {
+    CanFilter &f = plan.filters[plan.count++];
+    f.id = work[i].id;
+    f.mask = work[i].mask;
+    f.extended = false;
+    f.admitted = std_set_size(work[i].mask);
+    f.unwanted = f.admitted - std_wanted_in(work[i], groups, group_count);
+    plan.total_unwanted += f.unwanted;
+  }
+  for (uint8_t g = 0; g < group_count; g++) {
+    if (groups[g].extended) {
+      CanFilter &f = plan.filters[plan.count++];
+      f.mask = groups[g].mask & EXT_ID_MASK;
+      f.id = groups[g].id & f.mask;
+      f.extended = true;
+      f.admitted = 1u << (29 - __builtin_popcount(f.mask));
+      f.unwanted = 0; // Registered as-is, everything admitted is wanted
+    }
+  }
+  return true;
+}
@@ -6,30 +6,76 @@
  */
 
 // TODO:
-// - Verify and add CAN filters in setup_filters() for ALL required BMS message
-// IDs based on your specific Orion BMS configuration.
-// - Confirm Can0.read() behavior in the due_can library regarding reading from
-// multiple filtered mailboxes.
+// - Register handlers for ALL required BMS message IDs based on your specific
+// Orion BMS configuration (see BMSHandler::register_can_handlers()).
 
 #include "can_manager.h"
-#include "bamocar-due.h" // Include Bamocar header
-#include "bms_handler.h" // Include BMS handler header
+#include "logger.h"
+#include <atomic>  // For std::atomic_signal_fence (ISR ordering)
+#include <string.h> // For memset
 
 // Define the global instance
 CANManager can_manager;
 
-// Reference to the global Bamocar instance (assuming it's defined elsewhere,
-// e.g., motor_controller.cpp) If not global, this needs to be passed in or
-// handled differently.
-extern Bamocar bamocar; // Make sure Bamocar object is accessible
-
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
-CANManager::CANManager() {
-  // Initialize pointers if used, e.g.:
-  // bamocar_handler = nullptr;
-  // bms_handler = nullptr;
+CANManager::CANManager()
+    : rx_handler_count(0), tx_drop_count(0), tx_coalesced_count(0),
+      tx_fail_count(0), window_bits(0), window_start_ms(0),
+      window_rx_overflows(0), window_tx_drops(0), window_tx_failures(0),
+      window_rx_frames(0), window_tx_frames(0), rx_head(0), rx_tail(0),
+      rx_overflow_count(0), rx_high_water(0) {
+  memset(std_id_lookup, 0, sizeof(std_id_lookup));
+  memset(tx_queues, 0, sizeof(tx_queues));
+  memset(id_stats, 0, sizeof(id_stats));
+  memset(&bus_stats, 0, sizeof(bus_stats));
+}
+
+//------------------------------------------------------------------------------
+// RX Handler Registration
+//------------------------------------------------------------------------------
+bool CANManager::register_rx_handler(uint32_t id, CanRxHandler handler,
+                                     void *context, bool extended) {
+  uint32_t exact_mask = extended ? 0x1FFFFFFF : CAN_STD_ID_MASK;
+  return register_rx_handler(id, exact_mask, handler, context, extended);
+}
+
+bool CANManager::register_rx_handler(uint32_t id, uint32_t mask,
+                                     CanRxHandler handler, void *context,
+                                     bool extended) {
+  if (handler == nullptr || rx_handler_count >= CAN_MAX_RX_HANDLERS) {
+    return false;
+  }
+
+  if (!extended) {
+    id &= CAN_STD_ID_MASK;
+    mask &= CAN_STD_ID_MASK;
+    // Refuse overlapping claims so every ID has exactly one owner.
+    for (uint32_t rx_id = 0; rx_id < CAN_STD_ID_COUNT; rx_id++) {
+      if ((rx_id & mask) == (id & mask) && std_id_lookup[rx_id] != 0) {
+        if (DEBUG_MODE) {
+          Serial.print("CANManager: ID already claimed: 0x");
+          Serial.println(rx_id, HEX);
+        }
+        return false;
+      }
+    }
+    for (uint32_t rx_id = 0; rx_id < CAN_STD_ID_COUNT; rx_id++) {
+      if ((rx_id & mask) == (id & mask)) {
+        std_id_lookup[rx_id] = rx_handler_count + 1;
+      }
+    }
+  }
+
+  RxRegistration &reg = rx_handlers[rx_handler_count];
+  reg.id = id & mask;
+  reg.mask = mask;
+  reg.extended = extended;
+  reg.handler = handler;
+  reg.context = context;
+  rx_handler_count++;
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -53,6 +99,10 @@ bool CANManager::initialize(uint32_t baudrate) {
     // return false;
   }
 
+  // Route every accepted frame through our ISR-fed ring buffer instead of
+  // leaving it in the mailbox until the next loop() pass.
+  Can0.setGeneralCallback(CANManager::rx_isr_callback);
+
   if (DEBUG_MODE) {
     Serial.println("CAN0 Initialized Successfully with Filters.");
   }
@@ -63,110 +113,368 @@ bool CANManager::initialize(uint32_t baudrate) {
 // Configure Hardware Filters
 //------------------------------------------------------------------------------
 bool CANManager::setup_filters() {
-  // Disable all mailboxes by default before configuring
-  Can0.disable_all_mailboxes();
-
   /*
    * Filter Configuration Strategy:
-   * Use specific mailboxes for high-priority messages (like Bamocar responses)
-   * Use other mailboxes with broader masks if needed for BMS or other nodes.
-   * Mailbox 0-7 available on CAN0 for SAM3X.
-   * We need to receive:
-   * - Bamocar responses (ID: BAMOCAR_TX_ID)
-   * - BMS messages (IDs: ORION_BMS_ID_1, ORION_BMS_ID_2, potentially others)
-   * Add filters for any other nodes as needed.
+   * Mailbox 0-7 available on CAN0 for SAM3X; the last CAN_NUM_TX_MAILBOXES
+   * are kept for transmit. The planner packs every registration made through
+   * register_rx_handler() into the remaining mailboxes, merging IDs into
+   * ID/mask pairs that admit as few unregistered IDs as possible.
    */
+  Can0.setNumTXBoxes(CAN_NUM_TX_MAILBOXES);
+
+  CanFilterGroup groups[CAN_MAX_RX_HANDLERS];
+  for (uint8_t i = 0; i < rx_handler_count; i++) {
+    groups[i].id = rx_handlers[i].id;
+    groups[i].mask = rx_handlers[i].mask;
+    groups[i].extended = rx_handlers[i].extended;
+  }
+
+  if (!plan_can_filters(groups, rx_handler_count, CAN_NUM_RX_MAILBOXES,
+                        filter_plan)) {
+    if (DEBUG_MODE) {
+      Serial.print("CANManager: Cannot fit RX registrations into mailboxes: ");
+      Serial.println(rx_handler_count);
+    }
+    return false;
+  }
+
+  for (uint8_t i = 0; i < filter_plan.count; i++) {
+    const CanFilter &f = filter_plan.filters[i];
+    if (Can0.setRXFilter(i, f.id, f.mask, f.extended) < 0)
+      return false;
 
-  // Example: Mailbox 0 for Bamocar responses (exact ID match)
-  // Mask 0x7FF means all ID bits must match.
-  // TODO: Verify BAMOCAR_TX_ID is correct for your setup
-  if (Can0.init_filter(0, BAMOCAR_TX_ID, CAN_STDID) != 1)
-    return false; // Filter for Bamocar TX ID
-  // Can0.set_filter_mask(0, 0x7FF, CAN_STDID); // Ensure exact match (often
-  // default)
-
-  // Example: Mailbox 1 for BMS Message ID 1 (exact ID match)
-  // TODO: Replace ORION_BMS_ID_1 with the actual configured ID
-  if (Can0.init_filter(1, ORION_BMS_ID_1, CAN_STDID) != 1)
-    return false; // Filter for BMS ID 1
-  // Can0.set_filter_mask(1, 0x7FF, CAN_STDID); // Ensure exact match
-
-  // Example: Mailbox 2 for BMS Message ID 2 (exact ID match)
-  // TODO: Replace ORION_BMS_ID_2 with the actual configured ID
-  if (Can0.init_filter(2, ORION_BMS_ID_2, CAN_STDID) != 1)
-    return false; // Filter for BMS ID 2
-  // Can0.set_filter_mask(2, 0x7FF, CAN_STDID); // Ensure exact match
-
-  // --- IMPORTANT ---
-  // TODO: Add filters here for ALL BMS message IDs you expect to receive from
-  // your Orion BMS. If there are many BMS messages, you might use a mask to
-  // accept a range, but specific filters are generally better if feasible.
-  // Example Mask for a range (e.g., 0x420 to 0x42F):
-  // int mailbox_index = 3; // Use next available mailbox
-  // uint32_t id_base = 0x420;
-  // uint32_t mask = 0x7F0; // Match upper bits, ignore lower 4 bits
-  // if (Can0.init_filter(mailbox_index, id_base, CAN_STDID) != 1) return false;
-  // if (Can0.set_filter_mask(mailbox_index, mask, CAN_STDID) != 1) return
-  // false;
-  // --- --- --- --- ---
-
-  // Add filters for other devices as needed...
+    if (DEBUG_MODE) {
+      Serial.print("CANManager: Mailbox ");
+      Serial.print(i);
+      Serial.print(" ID 0x");
+      Serial.print(f.id, HEX);
+      Serial.print(" Mask 0x");
+      Serial.print(f.mask, HEX);
+      Serial.print(" admits ");
+      Serial.print(f.admitted);
+      Serial.print(" IDs, unwanted ");
+      Serial.println(f.unwanted);
+    }
+  }
 
   return true; // Indicate success
 }
 
+//------------------------------------------------------------------------------
+// RX Interrupt Callback / Ring Buffer
+//------------------------------------------------------------------------------
+void CANManager::rx_isr_callback(CAN_FRAME *frame) {
+  can_manager.push_rx_frame_isr(*frame);
+}
+
+void CANManager::push_rx_frame_isr(const CAN_FRAME &frame) {
+  uint16_t head = rx_head;
+  uint16_t used = (uint16_t)(head - rx_tail);
+
+  if (used >= CAN_RX_RING_SIZE) {
+    // Ring full: drop the newest frame and count it. The consumer is behind.
+    rx_overflow_count++;
+    return;
+  }
+
+  rx_ring[head & (CAN_RX_RING_SIZE - 1)] = frame;
+  rx_ring_time_us[head & (CAN_RX_RING_SIZE - 1)] = micros();
+  // Frame contents must be visible before the consumer sees the new head.
+  std::atomic_signal_fence(std::memory_order_release);
+  rx_head = head + 1;
+
+  if (used + 1 > rx_high_water) {
+    rx_high_water = used + 1;
+  }
+}
+
+bool CANManager::pop_rx_frame(CAN_FRAME &frame, uint32_t &timestamp_us) {
+  uint16_t tail = rx_tail;
+  if (tail == rx_head) {
+    return false; // Empty
+  }
+  std::atomic_signal_fence(std::memory_order_acquire);
+  frame = rx_ring[tail & (CAN_RX_RING_SIZE - 1)];
+  timestamp_us = rx_ring_time_us[tail & (CAN_RX_RING_SIZE - 1)];
+  // Slot must be fully copied before the producer may reuse it.
+  std::atomic_signal_fence(std::memory_order_release);
+  rx_tail = tail + 1;
+  return true;
+}
+
+void CANManager::reset_rx_stats() {
+  rx_overflow_count = 0;
+  rx_high_water = 0;
+}
+
 //------------------------------------------------------------------------------
 // Process Incoming Messages
 //------------------------------------------------------------------------------
 void CANManager::process_incoming_messages() {
   CAN_FRAME incoming_frame;
+  uint32_t timestamp_us;
 
-  // Check if a message is available in any configured mailbox
-  if (Can0.available() > 0) {
-    // Read the message
-    // Note: Can0.read() might need adjustment if the library doesn't
-    // automatically check all filtered mailboxes. Check library docs.
-    // Assuming Can0.read pulls from the next available filtered mailbox.
-    if (Can0.read(incoming_frame)) {
-
-      // Dispatch based on CAN ID
-      switch (incoming_frame.id) {
-      case BAMOCAR_TX_ID:
-        // Pass the frame to the Bamocar handler
-        // Ensure 'bamocar' object is accessible here
-        bamocar.handle_incoming_frame(incoming_frame);
-        break;
+  // Drain everything the ISR has queued since the last pass. Frames that
+  // arrive while we are dispatching are picked up by the same loop.
+  while (pop_rx_frame(incoming_frame, timestamp_us)) {
+    record_rx(incoming_frame, timestamp_us);
+    dispatch_frame(incoming_frame);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Dispatch a Received Frame
+//------------------------------------------------------------------------------
+void CANManager::dispatch_frame(const CAN_FRAME &frame) {
+  const RxRegistration *reg = nullptr;
 
-      // TODO: Add cases for ALL expected BMS IDs here
-      case ORION_BMS_ID_1:
-      case ORION_BMS_ID_2:
-        // Pass the frame to the BMS handler
-        bms_handler.handle_incoming_frame(incoming_frame);
+  if (!frame.extended) {
+    uint8_t slot = std_id_lookup[frame.id & CAN_STD_ID_MASK];
+    if (slot != 0) {
+      reg = &rx_handlers[slot - 1];
+    }
+  } else {
+    // Extended IDs are rare on this bus, a short scan is fine.
+    for (uint8_t i = 0; i < rx_handler_count; i++) {
+      if (rx_handlers[i].extended &&
+          (frame.id & rx_handlers[i].mask) == rx_handlers[i].id) {
+        reg = &rx_handlers[i];
         break;
+      }
+    }
+  }
 
-        // Add cases for other device IDs here...
+  if (reg != nullptr) {
+    reg->handler(frame, reg->context);
+  } else {
+    bus_stats.rx_unclaimed++;
+    // Unregistered ID let through by a merged mailbox mask (see
+    // get_filter_plan()), or a misconfigured filter.
+    log_event<LOG_CAN_UNCLAIMED_ID>(frame.id);
+  }
+}
 
-      default:
-        // Handle unexpected but filtered messages if necessary
-        if (DEBUG_MODE) {
-          Serial.print("CANManager: Received unexpected filtered ID: 0x");
-          Serial.println(incoming_frame.id, HEX);
-        }
-        break;
+//------------------------------------------------------------------------------
+// Send CAN Message (queue)
+//------------------------------------------------------------------------------
+bool CANManager::send_message(const CAN_FRAME &frame, CanTxPriority priority,
+                              uint16_t coalesce_key) {
+  if (priority >= CAN_TX_PRIORITY_COUNT)
+    priority = CAN_TX_PRIORITY_TELEMETRY;
+  TxQueue &queue = tx_queues[priority];
+
+  // The queues are shared with the torque interrupt (VCU_TORQUE_ISR). No
+  // Serial in here: with interrupts masked a full TX buffer never drains.
+  CriticalSection lock;
+
+  // Latest value wins: overwrite a stale frame that has not gone out yet
+  if (coalesce_key != CAN_TX_NO_COALESCE) {
+    for (uint8_t i = 0; i < queue.count; i++) {
+      TxEntry &entry = queue.entries[(queue.head + i) % CAN_TX_QUEUE_DEPTH];
+      if (entry.coalesce_key == coalesce_key && entry.frame.id == frame.id &&
+          entry.frame.extended == frame.extended) {
+        entry.frame = frame;
+        tx_coalesced_count++;
+        process_outgoing_messages();
+        return true;
       }
-    } else {
-      if (DEBUG_MODE) {
-        Serial.println(
-            "CANManager: Can0.available() > 0 but Can0.read() failed.");
+    }
+  }
+
+  if (queue.count >= CAN_TX_QUEUE_DEPTH) {
+    tx_drop_count++;
+    log_event<LOG_CAN_TX_QUEUE_FULL>(frame.id);
+    return false;
+  }
+
+  TxEntry &entry =
+      queue.entries[(queue.head + queue.count) % CAN_TX_QUEUE_DEPTH];
+  entry.frame = frame;
+  entry.coalesce_key = coalesce_key;
+  queue.count++;
+
+  // Send straight away if the mailbox is free, so an idle bus adds no latency
+  process_outgoing_messages();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Move Queued Frames to the Hardware
+//------------------------------------------------------------------------------
+void CANManager::process_outgoing_messages() {
+  CriticalSection lock; // Shared with the torque interrupt, see send_message()
+  for (uint8_t p = 0; p < CAN_TX_PRIORITY_COUNT; p++) {
+    TxQueue &queue = tx_queues[p];
+    while (queue.count > 0) {
+      // Only hand over a frame when the TX mailbox is free. Anything given to
+      // due_can while it is busy would sit in its own FIFO, where it can no
+      // longer be coalesced or overtaken by a higher priority frame.
+      if (!(Can0.mailbox_get_status(CAN_TX_MAILBOX) & CAN_MSR_MRDY))
+        return;
+
+      CAN_FRAME frame = queue.entries[queue.head].frame; // sendFrame non-const
+      if (!Can0.sendFrame(frame)) {
+        tx_fail_count++;
+        return; // Leave it at the head, retry next pass
       }
+      record_tx(frame);
+      queue.head = (queue.head + 1) % CAN_TX_QUEUE_DEPTH;
+      queue.count--;
     }
   }
 }
 
 //------------------------------------------------------------------------------
-// Send CAN Message
+// Instrumentation
 //------------------------------------------------------------------------------
-bool CANManager::send_message(const CAN_FRAME &frame) {
-  // Use the due_can library function to send the frame
-  return Can0.sendFrame(frame);
+uint32_t CANManager::frame_bits(const CAN_FRAME &frame) {
+  // SOF..EOF + 3 bit interframe space: 47 bits standard, 67 extended, plus
+  // the payload. Stuffing is data dependent; ~10% is typical for our traffic.
+  uint32_t bits = (frame.extended ? 67 : 47) + 8u * frame.length;
+  return bits + bits / 10;
+}
+
+CanIdStats *CANManager::find_id_stats(uint32_t id, bool extended,
+                                      bool allocate) {
+  // Open addressing with linear probing, Fibonacci hash of the ID
+  uint32_t slot = ((id ^ (extended ? 0x80000000u : 0)) * 2654435761u) >>
+                  (32 - __builtin_ctz(CAN_STATS_MAX_IDS));
+  for (uint8_t probe = 0; probe < CAN_STATS_MAX_IDS; probe++) {
+    CanIdStats &entry = id_stats[(slot + probe) & (CAN_STATS_MAX_IDS - 1)];
+    if (entry.in_use) {
+      if (entry.id == id && entry.extended == extended)
+        return &entry;
+    } else {
+      if (!allocate)
+        return nullptr;
+      entry.in_use = true;
+      entry.id = id;
+      entry.extended = extended;
+      entry.min_interval_us = 0xFFFFFFFFu;
+      return &entry;
+    }
+  }
+  return nullptr; // Table full
+}
+
+void CANManager::record_rx(const CAN_FRAME &frame, uint32_t timestamp_us) {
+  bus_stats.rx_frames++;
+  window_rx_frames++;
+  window_bits += frame_bits(frame);
+
+  uint32_t latency_us = micros() - timestamp_us;
+  if (latency_us > bus_stats.max_rx_latency_us)
+    bus_stats.max_rx_latency_us = latency_us;
+
+  CanIdStats *stats = find_id_stats(frame.id, frame.extended, true);
+  if (stats == nullptr) {
+    bus_stats.untracked_ids++;
+    return;
+  }
+
+  if (stats->rx_count > 0) {
+    uint32_t interval = timestamp_us - stats->last_rx_us;
+    if (interval < stats->min_interval_us)
+      stats->min_interval_us = interval;
+    if (interval > stats->max_interval_us)
+      stats->max_interval_us = interval;
+
+    if (stats->rx_count == 1) {
+      stats->mean_interval_us = interval; // First interval seeds the average
+    } else {
+      int32_t error = (int32_t)(interval - stats->mean_interval_us);
+      stats->mean_interval_us += error / 16;
+      uint32_t deviation = (uint32_t)(error < 0 ? -error : error);
+      stats->jitter_us += ((int32_t)(deviation - stats->jitter_us)) / 16;
+    }
+  }
+  stats->last_rx_us = timestamp_us;
+  stats->rx_count++;
+}
+
+void CANManager::record_tx(const CAN_FRAME &frame) {
+  bus_stats.tx_frames++;
+  window_tx_frames++;
+  window_bits += frame_bits(frame);
+
+  CanIdStats *stats = find_id_stats(frame.id, frame.extended, true);
+  if (stats == nullptr) {
+    bus_stats.untracked_ids++;
+    return;
+  }
+  stats->tx_count++;
+}
+
+const CanIdStats *CANManager::get_id_stats(uint32_t id, bool extended) const {
+  return const_cast<CANManager *>(this)->find_id_stats(id, extended, false);
+}
+
+void CANManager::get_bus_stats(CanBusStats &stats) const {
+  CriticalSection lock; // TX counters may change in the torque interrupt
+  stats = bus_stats;
+  stats.rx_overflows = rx_overflow_count;
+  stats.rx_high_water = rx_high_water;
+  stats.tx_drops = tx_drop_count;
+  stats.tx_failures = tx_fail_count;
+  stats.tx_coalesced = tx_coalesced_count;
+}
+
+static uint8_t saturate_u8(uint32_t value) {
+  return value > 0xFF ? 0xFF : (uint8_t)value;
+}
+
+void CANManager::update_diagnostics() {
+  uint32_t now = millis();
+  uint32_t elapsed_ms = now - window_start_ms;
+  if (elapsed_ms < CAN_DIAG_PERIOD_MS)
+    return;
+
+  // Take and restart the window in one go: TX counters are also updated from
+  // the torque interrupt (VCU_TORQUE_ISR)
+  uint32_t bits, rx_window, tx_window;
+  uint32_t rx_overflows, tx_drops, tx_failures;
+  {
+    CriticalSection lock;
+    bits = window_bits;
+    rx_window = window_rx_frames;
+    tx_window = window_tx_frames;
+    rx_overflows = rx_overflow_count - window_rx_overflows;
+    tx_drops = tx_drop_count - window_tx_drops;
+    tx_failures = tx_fail_count - window_tx_failures;
+
+    window_start_ms = now;
+    window_bits = 0;
+    window_rx_frames = 0;
+    window_tx_frames = 0;
+    window_rx_overflows += rx_overflows;
+    window_tx_drops += tx_drops;
+    window_tx_failures += tx_failures;
+  }
+
+  // Close the window: load = bits sent or seen / bits the bus could carry.
+  // Frames rejected by the mailbox filters are never seen, so this is the
+  // VCU-visible load, a lower bound on the bus utilisation.
+  uint64_t capacity_bits = (uint64_t)CAN_BUS_BITRATE * elapsed_ms / 1000;
+  uint32_t load = (uint32_t)((uint64_t)bits * 1000 / capacity_bits);
+  bus_stats.visible_load_permille = load > 1000 ? 1000 : (uint16_t)load;
+  bus_stats.rx_frames_window = rx_window;
+  bus_stats.tx_frames_window = tx_window;
+
+  CAN_FRAME diag;
+  memset(&diag, 0, sizeof(diag));
+  diag.id = CAN_DIAG_TX_ID;
+  diag.extended = false;
+  diag.length = 8;
+  diag.data.bytes[0] = bus_stats.visible_load_permille & 0xFF;
+  diag.data.bytes[1] = bus_stats.visible_load_permille >> 8;
+  uint16_t rx_frames = rx_window > 0xFFFF ? 0xFFFF : rx_window;
+  diag.data.bytes[2] = rx_frames & 0xFF;
+  diag.data.bytes[3] = rx_frames >> 8;
+  diag.data.bytes[4] = saturate_u8(rx_overflows);
+  diag.data.bytes[5] = saturate_u8(tx_drops);
+  diag.data.bytes[6] = saturate_u8(tx_failures);
+  diag.data.bytes[7] = saturate_u8(rx_high_water);
+
+  // Only the latest diagnostic frame is worth sending
+  send_message(diag, CAN_TX_PRIORITY_TELEMETRY, 0);
 }
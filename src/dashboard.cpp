@@ -1,66 +1,154 @@
 // dashboard.cpp
 // Written by Shane Whelan
 // UCD Formula Student
+//
+// Dirty-tracking Nextion renderer (see dashboard.h). The ITEAD library is not
+// used: its setText() waits up to 100 ms for the display's reply.
 
+#include "dashboard.h"
 #include "header.h"
+#include <stdio.h>  // For snprintf
+#include <string.h> // For strcmp, strcpy
 
-// Define Nextion text objects for variables
-NexText e1 = NexText(1, 4, "t1");  
-NexText e2 = NexText(1, 5, "t2"); 
-NexText e3 = NexText(1, 6, "t3");  
-NexText e4 = NexText(1, 7, "t4");  
-NexText e5 = NexText(1, 8, "t5");  
+// Every Nextion instruction ends with three 0xFF bytes
+static const uint8_t nextion_terminator[3] = {0xFF, 0xFF, 0xFF};
 
-// Nextion touch event list (not used yet, could be removed if touch function unused in final code)
-NexTouch *nex_listen_list[] = { NULL };
+// <object>.txt="<text>", object names up to 8 characters
+#define DASH_COMMAND_MAX (16 + DASH_TEXT_MAX)
 
-// Variables for elapsed time
-unsigned long elapsedMillis = 0;
-unsigned long previousMillis = 0;
+typedef void (*DashFormat)(char *text, size_t size);
 
-// Buffer for text conversion
-char buffer[40];
+// One row of the (const) field table
+typedef struct {
+  const char *object;   // Nextion text object on page 1
+  uint16_t interval_ms; // Minimum time between two updates of this field
+  DashFormat format;    // Writes the current value as text
+} DashField;
+
+// Run-time state per field
+typedef struct {
+  char sent[DASH_TEXT_MAX]; // What the display shows ("" = unknown)
+  uint32_t last_sent_ms;
+} DashFieldState;
+
+//------------------------------------------------------------------------------
+// Field Values
+//------------------------------------------------------------------------------
+static void format_brake_pressure(char *text, size_t size) {
+  snprintf(text, size, "%d", brakePressure);
+}
+
+// Heartbeat: shows the display is still being updated
+static void format_heartbeat(char *text, size_t size) {
+  snprintf(text, size, "%d", (int)(millis() % 5000));
+}
+
+static void format_label(char *text, size_t size) {
+  snprintf(text, size, "millie");
+}
+
+// Time since power-up, hh:mm:ss.t
+static void format_elapsed_time(char *text, size_t size) {
+  unsigned long now = millis();
+  unsigned long total_seconds = now / 1000;
+  int hours = total_seconds / 3600;
+  int minutes = (total_seconds % 3600) / 60;
+  int seconds = total_seconds % 60;
+  int tenths = (now % 1000) / 100;
+  snprintf(text, size, "%02d:%02d:%02d.%d", hours, minutes, seconds, tenths);
+}
+
+static void format_motor_speed(char *text, size_t size) {
+  snprintf(text, size, "%d", bamocar.getSpeedRpm());
+}
+
+// Intervals are multiples of the dashboard task period (main.cpp)
+static const DashField fields[] = {
+    // object, interval_ms, format
+    {"t1", 100, format_brake_pressure},
+    {"t2", 500, format_heartbeat},
+    {"t3", 1000, format_label},
+    {"t4", 100, format_elapsed_time},
+    {"t5", 100, format_motor_speed},
+};
+
+#define DASH_NUM_FIELDS (sizeof(fields) / sizeof(fields[0]))
+
+static DashFieldState field_state[DASH_NUM_FIELDS];
+static DashStats stats;
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+// Queues one raw instruction if the UART buffer can take all of it
+static bool send_command(const char *command) {
+  size_t length = strlen(command);
+  if ((size_t)Serial1.availableForWrite() < length + sizeof(nextion_terminator))
+    return false;
+  Serial1.write((const uint8_t *)command, length);
+  Serial1.write(nextion_terminator, sizeof(nextion_terminator));
+  stats.bytes_sent += length + sizeof(nextion_terminator);
+  return true;
+}
 
 void dash_setup() {
-  Serial1.begin(9600);  // Serial for Nextion communication
-  
-  // Initialize the Nextion display
-  nexInit();
-  
-  Serial.println("Nextion display initialized!");
+  // The display may still be at its stored rate (power-up) or already at
+  // DASH_BAUD_RATE (VCU reset only), so send the switch at both rates; the
+  // copy at the wrong rate is ignored as garbage.
+  Serial1.begin(DASH_BOOT_BAUD_RATE);
+  char command[24];
+  snprintf(command, sizeof(command), "baud=%lu", (unsigned long)DASH_BAUD_RATE);
+  Serial1.write((const uint8_t *)command, strlen(command));
+  Serial1.write(nextion_terminator, sizeof(nextion_terminator));
+  Serial1.flush(); // ~15 ms at 9600 baud
+  delay(20);       // Display switching rate
+
+  Serial1.begin(DASH_BAUD_RATE);
+  send_command(command);
+  send_command("bkcmd=0"); // No replies; nothing reads Serial1 RX
+  Serial1.flush();
+
+  dash_invalidate();
+  memset(&stats, 0, sizeof(stats));
+
+  if (DEBUG_MODE) {
+    Serial.println("Nextion display initialized!");
+  }
 }
 
 void dash_loop() {
-  // Calculate elapsed time
-  unsigned long currentMillis = millis();
-  elapsedMillis += currentMillis - previousMillis;
-  previousMillis = currentMillis;
-
-  // Convert elapsed time into hours, minutes, and seconds
-  unsigned long totalSeconds = elapsedMillis / 1000;
-  int hours = totalSeconds / 3600;
-  int minutes = (totalSeconds % 3600) / 60;
-  int seconds = totalSeconds % 60;
-  int fracSecs = (millis()%1000) / 10;
-  int mod_millis = millis() % 5000;
-
-  // Update e1 on the Nextion display
-  sprintf(buffer, "%d", brakePressure);
-  e1.setText(buffer);
-
-  // Update milliseconds mod value on the Nextion display
-  sprintf(buffer, "%d", mod_millis);
-  e2.setText(buffer);
-
-  // Update the text component on the Nextion display
-  sprintf(buffer, "millie");
-  e3.setText(buffer);
-
-  // Update the time in the e4 field
-  sprintf(buffer, "%02d:%02d:%02d.%02d", hours, minutes, seconds, fracSecs);
-  e4.setText(buffer);
-
-  int speed = (rand() % (101)) + 100;
-  sprintf(buffer, "%d", brakePressure);
-  e5.setText(buffer);
-}
\ No newline at end of file
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < DASH_NUM_FIELDS; i++) {
+    const DashField &field = fields[i];
+    DashFieldState &state = field_state[i];
+    if (now - state.last_sent_ms < field.interval_ms)
+      continue;
+
+    char text[DASH_TEXT_MAX];
+    field.format(text, sizeof(text));
+    if (strcmp(text, state.sent) == 0) {
+      stats.unchanged++; // Interval left expired: a change goes out at once
+      continue;
+    }
+
+    char command[DASH_COMMAND_MAX];
+    snprintf(command, sizeof(command), "%s.txt=\"%s\"", field.object, text);
+    if (!send_command(command)) {
+      stats.deferred++; // Still differs from state.sent; retried next pass
+      continue;
+    }
+    strcpy(state.sent, text);
+    state.last_sent_ms = now;
+    stats.commands_sent++;
+  }
+}
+
+void dash_invalidate() {
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < DASH_NUM_FIELDS; i++) {
+    field_state[i].sent[0] = '\0';
+    field_state[i].last_sent_ms = now - fields[i].interval_ms; // Due now
+  }
+}
+
+const DashStats &dash_get_stats() { return stats; }
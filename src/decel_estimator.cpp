@@ -0,0 +1,220 @@
+/**
+ * @file decel_estimator.cpp
+ * @brief Implements the deceleration estimator (see decel_estimator.h).
+ * Integer-only: the Due has no FPU and this runs at 200 Hz.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "decel_estimator.h"
+#include "header.h"
+#include <string.h> // For memset
+
+//------------------------------------------------------------------------------
+// Integer Biquad (Direct Form I)
+//------------------------------------------------------------------------------
+// Coefficients in Q28 (a1 reaches -2 for low cutoffs). The state keeps
+// BIQUAD_STATE_SHIFT fraction bits so slow filters do not stall on
+// truncation; the sums fit int64_t, which the M3 does with SMULL/SMLAL.
+#define BIQUAD_COEFF_SHIFT 28
+#define BIQUAD_STATE_SHIFT 8
+
+typedef struct {
+  int32_t b0, b1, b2, a1, a2; // y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2
+} BiquadCoeffs;
+
+typedef struct {
+  int32_t x1, x2, y1, y2; // Past inputs / outputs << BIQUAD_STATE_SHIFT
+} BiquadState;
+
+// 2nd order Butterworth low-pass, bilinear transform at 200 Hz. b1 is
+// adjusted so b0 + b1 + b2 = 1 + a1 + a2 exactly: unity DC gain, no offset.
+static const BiquadCoeffs accel_lowpass = {
+    1487862, 2975724, 1487862, -477447832, 214963824}; // 5 Hz
+static const BiquadCoeffs speed_lowpass = {
+    558498, 1116996, 558498, -501140080, 234938616}; // 3 Hz (derivative)
+
+static_assert(DECEL_SAMPLE_RATE_HZ == 200,
+              "Biquad coefficients are designed for 200 Hz");
+
+/**
+ * @brief Sets the filter to a steady state at the given input, so a channel
+ * that (re)starts does not ring from zero.
+ */
+static void biquad_prime(BiquadState &state, int32_t value) {
+  int32_t scaled = value * (1 << BIQUAD_STATE_SHIFT);
+  state.x1 = state.x2 = state.y1 = state.y2 = scaled;
+}
+
+/**
+ * @brief One sample through the filter: five multiply-accumulates.
+ * @return Filtered output in the input's units.
+ */
+static int32_t biquad_step(const BiquadCoeffs &c, BiquadState &state,
+                           int32_t input) {
+  int32_t x0 = input * (1 << BIQUAD_STATE_SHIFT);
+  int64_t acc = (int64_t)c.b0 * x0 + (int64_t)c.b1 * state.x1 +
+                (int64_t)c.b2 * state.x2 - (int64_t)c.a1 * state.y1 -
+                (int64_t)c.a2 * state.y2;
+  int32_t y0 = (int32_t)(acc >> BIQUAD_COEFF_SHIFT);
+  state.x2 = state.x1;
+  state.x1 = x0;
+  state.y2 = state.y1;
+  state.y1 = y0;
+  return y0 >> BIQUAD_STATE_SHIFT;
+}
+
+//------------------------------------------------------------------------------
+// State
+//------------------------------------------------------------------------------
+// mm/s per motor RPM in Q12 (2 * PI * r / (60 * gear ratio)); fits int32_t
+// for any 16-bit RPM
+#define DECEL_MM_S_PER_RPM_SHIFT 12
+static const int32_t DECEL_MM_S_PER_RPM_Q12 =
+    (int32_t)(2.0 * PI * DECEL_WHEEL_RADIUS_MM * 100.0 *
+                  (1 << DECEL_MM_S_PER_RPM_SHIFT) /
+                  (60.0 * DECEL_GEAR_RATIO_X100) +
+              0.5);
+
+// A speed step beyond this (10 g) is a CAN glitch, not braking; clamping it
+// also keeps the filter input inside int32_t << BIQUAD_STATE_SHIFT
+static const int32_t DECEL_SPEED_STEP_LIMIT_MM_S2 = 100000;
+
+// Channel state. Only the decel task writes it; readers in other contexts
+// use the two volatile words below.
+static BiquadState accel_state;
+static BiquadState speed_state;
+static bool accel_running = false;
+static bool speed_running = false;
+static uint32_t last_mpu_sequence = 0;
+static uint32_t last_speed_count = 0;
+static uint32_t last_speed_change_us = 0;
+static int32_t last_speed_mm_s = 0;
+static DecelEstimate estimate;
+
+static volatile int32_t published_decel_mm_s2 = 0;
+static volatile bool published_braking = false;
+
+void decel_estimator_begin() {
+  memset(&accel_state, 0, sizeof(accel_state));
+  memset(&speed_state, 0, sizeof(speed_state));
+  memset(&estimate, 0, sizeof(estimate));
+  accel_running = false;
+  speed_running = false;
+  last_speed_count = bamocar.getSpeedUpdateCount();
+  last_speed_change_us = micros();
+  published_decel_mm_s2 = 0;
+  published_braking = false;
+}
+
+//------------------------------------------------------------------------------
+// Channels
+//------------------------------------------------------------------------------
+/**
+ * @brief Accelerometer channel: one filter step per new MPU sample. Holds
+ * the last output between samples; drops out when the sampler goes stale.
+ * @return True if the channel is usable.
+ */
+static bool update_accel_channel() {
+  MpuSample sample;
+  if (!mpu_sampler_read(sample)) {
+    accel_running = false;
+    return false;
+  }
+  if (accel_running && sample.sequence == last_mpu_sequence)
+    return true; // No new sample since the last step
+  last_mpu_sequence = sample.sequence;
+
+  int32_t decel = DECEL_ACCEL_SIGN * sample.accel_mm_s2[DECEL_ACCEL_AXIS];
+  if (!accel_running) {
+    biquad_prime(accel_state, decel);
+    accel_running = true;
+  }
+  estimate.accel_decel_mm_s2 = biquad_step(accel_lowpass, accel_state, decel);
+  return true;
+}
+
+/**
+ * @brief Motor speed channel: backward difference of the vehicle speed at
+ * DECEL_SAMPLE_RATE_HZ, then the low-pass. Runs every step, so a repeated
+ * speed value reads as zero change and the filter averages it out.
+ * @return True if the channel is usable.
+ */
+static bool update_speed_channel(uint32_t now_us) {
+  uint32_t count = bamocar.getSpeedUpdateCount();
+  if (count != last_speed_count) {
+    last_speed_count = count;
+    last_speed_change_us = now_us;
+  } else if (now_us - last_speed_change_us > DECEL_SPEED_MAX_AGE_US) {
+    speed_running = false;
+    return false;
+  }
+
+  int32_t speed_mm_s =
+      ((int32_t)bamocar.getSpeedRpm() * DECEL_MM_S_PER_RPM_Q12) >>
+      DECEL_MM_S_PER_RPM_SHIFT;
+  if (speed_mm_s < 0)
+    speed_mm_s = -speed_mm_s; // Slowing down in reverse is also braking
+  if (!speed_running) {
+    last_speed_mm_s = speed_mm_s;
+    biquad_prime(speed_state, 0);
+    speed_running = true;
+  }
+  int32_t decel = (last_speed_mm_s - speed_mm_s) * DECEL_SAMPLE_RATE_HZ;
+  last_speed_mm_s = speed_mm_s;
+  if (decel > DECEL_SPEED_STEP_LIMIT_MM_S2) {
+    decel = DECEL_SPEED_STEP_LIMIT_MM_S2;
+  } else if (decel < -DECEL_SPEED_STEP_LIMIT_MM_S2) {
+    decel = -DECEL_SPEED_STEP_LIMIT_MM_S2;
+  }
+  estimate.speed_decel_mm_s2 = biquad_step(speed_lowpass, speed_state, decel);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Update
+//------------------------------------------------------------------------------
+void decel_estimator_update() {
+  uint32_t now_us = micros();
+  bool accel_ok = update_accel_channel();
+  bool speed_ok = update_speed_channel(now_us);
+
+  int32_t decel;
+  if (accel_ok && speed_ok) {
+    decel = (int32_t)(((int64_t)estimate.accel_decel_mm_s2 *
+                           DECEL_ACCEL_WEIGHT_Q15 +
+                       (int64_t)estimate.speed_decel_mm_s2 *
+                           (32768 - DECEL_ACCEL_WEIGHT_Q15)) >>
+                      15);
+  } else if (accel_ok) {
+    decel = estimate.accel_decel_mm_s2;
+  } else if (speed_ok) {
+    decel = estimate.speed_decel_mm_s2;
+  } else {
+    decel = 0;
+  }
+
+  bool braking = estimate.braking;
+  if (decel > DECEL_ON_THRESHOLD_MM_S2) {
+    braking = true;
+  } else if (decel < DECEL_OFF_THRESHOLD_MM_S2) {
+    braking = false;
+  }
+
+  estimate.decel_mm_s2 = decel;
+  estimate.sources = (accel_ok ? DECEL_SOURCE_ACCEL : 0) |
+                     (speed_ok ? DECEL_SOURCE_SPEED : 0);
+  estimate.braking = braking;
+  estimate.timestamp_us = now_us;
+  published_decel_mm_s2 = decel;
+  published_braking = braking;
+}
+
+//------------------------------------------------------------------------------
+// Readers
+//------------------------------------------------------------------------------
+int32_t decel_estimator_get_mm_s2() { return published_decel_mm_s2; }
+
+bool decel_estimator_is_braking() { return published_braking; }
+
+void decel_estimator_read(DecelEstimate &out) { out = estimate; }
@@ -0,0 +1,141 @@
+/**
+ * @file fault_manager.cpp
+ * @brief Implements the FaultManager class (see fault_manager.h).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "fault_manager.h"
+#include "header.h"
+#include "logger.h"
+#include <string.h> // For memset
+
+static_assert(FAULT_COUNT <= sizeof(FaultMask) * 8,
+              "FaultMask has one bit per fault");
+static_assert((FAULT_HISTORY_SIZE & (FAULT_HISTORY_SIZE - 1)) == 0,
+              "FAULT_HISTORY_SIZE must be a power of 2");
+
+// Same order as FaultId
+static const char *const fault_names[FAULT_COUNT] = {
+    "apps_implausible", "apps_brake", "bms_critical",
+    "bms_comm_lost",    "imd",        "bspd",
+};
+
+FaultManager fault_manager;
+
+FaultManager::FaultManager() : active(0), latched(0), transition_count(0) {
+  memset(records, 0, sizeof(records));
+  memset(history, 0, sizeof(history));
+}
+
+//------------------------------------------------------------------------------
+// Reporting
+//------------------------------------------------------------------------------
+bool FaultManager::set(FaultId id, bool now_active) {
+  FaultMask bit = FAULT_BIT(id);
+  if (((active & bit) != 0) == now_active)
+    return false; // Common case: no change, no lock
+
+  uint32_t now_us = micros();
+  uint32_t now_ms = millis();
+  FaultMask active_after;
+  {
+    // Faults are reported from the loop and from the torque interrupt
+    CriticalSection lock;
+    FaultRecord &record = records[id];
+    if (now_active) {
+      active = active | bit;
+      latched = latched | bit;
+      if (record.set_count == 0)
+        record.first_set_ms = now_ms;
+      record.set_count++;
+      record.last_set_ms = now_ms;
+    } else {
+      active = active & (FaultMask)~bit;
+      record.last_clear_ms = now_ms;
+    }
+    active_after = active;
+
+    FaultTransition &entry =
+        history[transition_count & (FAULT_HISTORY_SIZE - 1)];
+    entry.timestamp_us = now_us;
+    entry.fault = (uint8_t)id;
+    entry.active = now_active;
+    entry.active_mask = active_after;
+    transition_count++;
+  }
+
+  if (now_active) {
+    log_event<LOG_FAULT_SET>(id, active_after);
+  } else {
+    log_event<LOG_FAULT_CLEARED>(id, active_after);
+  }
+  return true;
+}
+
+void FaultManager::clear_latched() {
+  CriticalSection lock;
+  latched = active;
+}
+
+const char *FaultManager::get_name(FaultId id) {
+  return id < FAULT_COUNT ? fault_names[id] : "unknown";
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+void FaultManager::print_history() const {
+  FaultMask active_copy, latched_copy;
+  FaultRecord records_copy[FAULT_COUNT];
+  FaultTransition history_copy[FAULT_HISTORY_SIZE];
+  uint32_t count;
+  {
+    CriticalSection lock; // One consistent picture, printed without the lock
+    active_copy = active;
+    latched_copy = latched;
+    memcpy(records_copy, records, sizeof(records_copy));
+    memcpy(history_copy, history, sizeof(history_copy));
+    count = transition_count;
+  }
+
+  Serial.print("Faults: active 0x");
+  Serial.print(active_copy, HEX);
+  Serial.print(", latched 0x");
+  Serial.print(latched_copy, HEX);
+  Serial.print(", torque ");
+  Serial.println((active_copy & FAULT_TORQUE_MASK) ? "INHIBITED" : "ok");
+  Serial.println("  fault, count, first_ms, last_set_ms, last_clear_ms");
+  for (uint8_t i = 0; i < FAULT_COUNT; i++) {
+    const FaultRecord &r = records_copy[i];
+    if (r.set_count == 0)
+      continue;
+    Serial.print("  ");
+    Serial.print(fault_names[i]);
+    Serial.print(", ");
+    Serial.print(r.set_count);
+    Serial.print(", ");
+    Serial.print(r.first_set_ms);
+    Serial.print(", ");
+    Serial.print(r.last_set_ms);
+    Serial.print(", ");
+    Serial.print(r.last_clear_ms);
+    Serial.println((active_copy & FAULT_BIT(i)) ? " (ACTIVE)" : "");
+  }
+
+  uint32_t kept = count < FAULT_HISTORY_SIZE ? count : FAULT_HISTORY_SIZE;
+  Serial.print("Fault transitions, oldest first (last ");
+  Serial.print(kept);
+  Serial.print(" of ");
+  Serial.print(count);
+  Serial.println("): time_us, fault, SET/CLEAR, active");
+  for (uint32_t n = count - kept; n != count; n++) {
+    const FaultTransition &t = history_copy[n & (FAULT_HISTORY_SIZE - 1)];
+    Serial.print("  ");
+    Serial.print(t.timestamp_us);
+    Serial.print(", ");
+    Serial.print(get_name((FaultId)t.fault));
+    Serial.print(t.active ? ", SET, 0x" : ", CLEAR, 0x");
+    Serial.println(t.active_mask, HEX);
+  }
+}
@@ -0,0 +1,166 @@
+/**
+ * @file logger.cpp
+ * @brief Implements the binary ring-buffer event logger (see logger.h).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "logger.h"
+#include "header.h"
+#include <atomic> // For std::atomic_signal_fence (ISR ordering)
+
+static_assert((LOGGER_BUFFER_SIZE & (LOGGER_BUFFER_SIZE - 1)) == 0,
+              "LOGGER_BUFFER_SIZE must be a power of 2");
+static_assert(LOG_EVENT_COUNT <= 256, "Event IDs are sent as one byte");
+
+#define LOGGER_MASK (LOGGER_BUFFER_SIZE - 1)
+
+// Free-running byte indices. Writers (any context) advance head inside a
+// critical section; only logger_drain() advances tail.
+static uint8_t log_buffer[LOGGER_BUFFER_SIZE];
+static volatile uint32_t log_head = 0;
+static volatile uint32_t log_tail = 0;
+static volatile uint32_t dropped_count = 0;
+static uint32_t pending_drops = 0; // Not yet reported (LOGGER_DROPPED)
+static uint32_t high_water = 0;
+
+static inline uint8_t record_size(uint8_t argc) {
+  return LOG_RECORD_HEADER_BYTES + 4 * argc + 1;
+}
+
+// Serialises one record at head; caller has checked the space
+static uint32_t put_record(uint32_t head, uint8_t id, uint32_t timestamp_us,
+                           const int32_t *args, uint8_t count) {
+  uint8_t record[LOG_RECORD_MAX_BYTES];
+  uint8_t n = 0;
+  record[n++] = LOGGER_SYNC_BYTE;
+  record[n++] = id;
+  record[n++] = count;
+  for (uint8_t b = 0; b < 4; b++) {
+    record[n++] = (uint8_t)(timestamp_us >> (8 * b));
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    uint32_t value = (uint32_t)args[i];
+    for (uint8_t b = 0; b < 4; b++) {
+      record[n++] = (uint8_t)(value >> (8 * b));
+    }
+  }
+  uint8_t checksum = 0;
+  for (uint8_t i = 1; i < n; i++) {
+    checksum ^= record[i];
+  }
+  record[n++] = checksum;
+
+  for (uint8_t i = 0; i < n; i++) {
+    log_buffer[(head + i) & LOGGER_MASK] = record[i];
+  }
+  return head + n;
+}
+
+//------------------------------------------------------------------------------
+// Writing
+//------------------------------------------------------------------------------
+void logger_write(LogEventId id, const int32_t *args, uint8_t count) {
+  if (count > LOG_MAX_ARGS)
+    count = LOG_MAX_ARGS;
+  uint32_t now = micros();
+
+  CriticalSection lock; // Writers may be the torque interrupt and the loop
+  uint32_t head = log_head;
+  uint32_t free_bytes = LOGGER_BUFFER_SIZE - (head - log_tail);
+  uint32_t needed = record_size(count);
+  if (pending_drops > 0)
+    needed += record_size(1);
+  if (needed > free_bytes) {
+    dropped_count++;
+    pending_drops++;
+    return;
+  }
+
+  if (pending_drops > 0) {
+    int32_t drops = (int32_t)pending_drops;
+    head = put_record(head, LOG_LOGGER_DROPPED, now, &drops, 1);
+    pending_drops = 0;
+  }
+  head = put_record(head, id, now, args, count);
+  // Record bytes must be in place before the drain sees the new head
+  std::atomic_signal_fence(std::memory_order_release);
+  log_head = head;
+
+  uint32_t used = head - log_tail;
+  if (used > high_water)
+    high_water = used;
+}
+
+//------------------------------------------------------------------------------
+// Draining
+//------------------------------------------------------------------------------
+#if !defined(ARDUINO_ARCH_SAM)
+// Host build: render the text here instead of leaving it to log_decode.py
+#include <stdio.h>
+
+static const char *const event_formats[LOG_EVENT_COUNT] = {
+#define LOG_EVENT(name, category, level, format) format,
+#include "log_events.def"
+#undef LOG_EVENT
+};
+
+static void print_record(const uint8_t *record) {
+  uint8_t argc = record[2];
+  uint32_t timestamp_us = 0;
+  int32_t args[LOG_MAX_ARGS] = {0};
+  for (uint8_t b = 0; b < 4; b++) {
+    timestamp_us |= (uint32_t)record[3 + b] << (8 * b);
+  }
+  for (uint8_t i = 0; i < argc; i++) {
+    const uint8_t *bytes = &record[LOG_RECORD_HEADER_BYTES + 4 * i];
+    uint32_t value = 0;
+    for (uint8_t b = 0; b < 4; b++) {
+      value |= (uint32_t)bytes[b] << (8 * b);
+    }
+    args[i] = (int32_t)value;
+  }
+  char text[160];
+  snprintf(text, sizeof(text), event_formats[record[1]], (int)args[0],
+           (int)args[1], (int)args[2], (int)args[3]);
+  Serial.print("[");
+  Serial.print((unsigned long)timestamp_us);
+  Serial.print("] ");
+  Serial.println(text);
+}
+#endif
+
+void logger_drain() {
+  while (true) {
+    uint32_t tail = log_tail;
+    if (tail == log_head)
+      return; // Empty
+    std::atomic_signal_fence(std::memory_order_acquire);
+
+    uint8_t argc = log_buffer[(tail + 2) & LOGGER_MASK];
+    uint8_t size = record_size(argc);
+#if defined(ARDUINO_ARCH_SAM)
+    // Whole records only, so text printed between drains never splits one
+    if (Serial.availableForWrite() < size)
+      return;
+#endif
+
+    uint8_t record[LOG_RECORD_MAX_BYTES];
+    for (uint8_t i = 0; i < size; i++) {
+      record[i] = log_buffer[(tail + i) & LOGGER_MASK];
+    }
+    // Slot must be fully copied before a writer may reuse it
+    std::atomic_signal_fence(std::memory_order_release);
+    log_tail = tail + size;
+
+#if defined(ARDUINO_ARCH_SAM)
+    Serial.write(record, size);
+#else
+    print_record(record);
+#endif
+  }
+}
+
+uint32_t logger_get_dropped_count() { return dropped_count; }
+
+uint32_t logger_get_high_water() { return high_water; }
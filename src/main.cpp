@@ -10,18 +10,233 @@
 #include "bamocar-due.h"
 #include "bms_handler.h"
 #include "can_manager.h"
+#include "cycle_counter.h"
 #include "header.h"
+#include "logger.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "torque_isr.h"
 
 // Global variables defined elsewhere (e.g., globals.h, brake_light.cpp)
 extern int brakePressure; // Assuming brake_light.cpp defines and updates this
 
-// Define MPU object if used globally (e.g., for brake light tilt)
-Adafruit_MPU6050 mpu; // Define it here
+// MPU6050 driver, used by mpu_sampler_begin() to find and set up the sensor
+Adafruit_MPU6050 mpu;
+
+//------------------------------------------------------------------------------
+// TASKS
+//------------------------------------------------------------------------------
+// 1 kHz: CAN in -> torque control -> CAN out, back to back, so a fresh
+// BMS/Bamocar frame reaches the torque command within one period. With
+// VCU_TORQUE_ISR this runs from the TC timer interrupt instead (see setup()),
+// so it must stay free of Serial, I2C and blocking waits.
+static void task_control() {
+  // Reads messages from CAN buffer and dispatches to handlers (BMS, Bamocar)
+  {
+    PROFILE_SCOPE(PROFILE_CAN_RX);
+    can_manager.process_incoming_messages();
+  }
+
+  // Reads APPS, performs safety checks (APPS plausibility, APPS/Brake, BMS
+  // status), determines final torque command, and queues it via CANManager.
+  {
+    PROFILE_SCOPE(PROFILE_MOTOR_CONTROL);
+    motor_control_update();
+  }
+
+  // Push whatever is still queued for CAN TX (highest priority first)
+  {
+    PROFILE_SCOPE(PROFILE_CAN_TX);
+    can_manager.process_outgoing_messages();
+  }
+}
+
+// One filter step of the accelerometer and motor speed channels
+static void task_decel_estimator() {
+  PROFILE_SCOPE(PROFILE_DECEL_ESTIMATOR);
+  decel_estimator_update();
+}
+
+// Reads brake pressure ADC and the deceleration estimate, updates the light
+static void task_brake_light() {
+  PROFILE_SCOPE(PROFILE_BRAKE_LIGHT);
+  brake_light();
+}
+
+// Samples error input pins 22-37 into the fault word
+static void task_error_monitor() {
+  PROFILE_SCOPE(PROFILE_ERROR_MONITOR);
+  monitor_errors_loop();
+}
+
+// Latches a BMS communication fault once the BMS goes quiet
+static void task_bms_supervision() {
+  PROFILE_SCOPE(PROFILE_BMS_SUPERVISION);
+  bms_handler.update_supervision();
+}
+
+// Status/temperature/speed requests to the Bamocar
+static void task_bamocar_requests() {
+  PROFILE_SCOPE(PROFILE_BAMOCAR_REQUESTS);
+  motor_control_request_feedback();
+}
+
+// VCU-visible load window / periodic diagnostic frame (CAN_DIAG_TX_ID)
+static void task_can_diagnostics() {
+  PROFILE_SCOPE(PROFILE_CAN_DIAGNOSTICS);
+  can_manager.update_diagnostics();
+}
+
+// Nextion display: changed fields only, never waits for the UART
+static void task_dashboard() {
+  PROFILE_SCOPE(PROFILE_DASHBOARD);
+  dash_loop();
+}
+
+// Moves binary log records (logger.h) to Serial as the UART has room
+static void task_log_drain() { logger_drain(); }
+
+// Serial commands: 'f' dumps the fault history, 'c' clears latched faults;
+// 'm' picks the next torque map profile (applied on the next lift-off, see
+// torque_map.h); 'p' prints the profiler
+// tables, 'r' resets them
+static void task_console() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == 'f') {
+      fault_manager.print_history();
+    } else if (c == 'c') {
+      fault_manager.clear_latched();
+      Serial.println("Faults: Latched set cleared.");
+    } else if (c == 'm') {
+      TorqueProfile next =
+          (TorqueProfile)((torque_map_get_pending() + 1) %
+                          TORQUE_PROFILE_COUNT);
+      torque_map_select(next);
+      Serial.print("Torque map: ");
+      Serial.print(torque_map_profile_name(next));
+      Serial.println(" (pending until off throttle)");
+    } else {
+#if VCU_PROFILING
+      profiler_console_command(c);
+#endif
+    }
+  }
+}
+
+// Status print for bench debugging (DEBUG_MODE >= 3)
+static void task_debug_status() {
+  PROFILE_SCOPE(PROFILE_DEBUG_STATUS);
+  Serial.println("--- Loop Status ---");
+  // Print key variables like APPS %, Brake Pressure, BMS SoC, Bamocar
+  // Status etc.
+  BMSData bms_data;
+  bms_handler.read_snapshot(bms_data);
+  Serial.print("  BMS SoC: ");
+  Serial.print(bms_data.pack_soc);
+  Serial.println("%");
+  Serial.print("  BMS Voltage: ");
+  Serial.print(bms_data.pack_voltage);
+  Serial.println(" V");
+  Serial.print("  BMS Fault: ");
+  Serial.println(BMSHandler::has_critical_fault(bms_data) ? "YES" : "NO");
+  Serial.print("  BMS Generation: ");
+  Serial.println(bms_data.generation);
+  Serial.print("  Cells min / max / avg (mV): ");
+  Serial.print(bms_data.cell_min_mv);
+  Serial.print(" (#");
+  Serial.print(bms_data.cell_min_id);
+  Serial.print(") / ");
+  Serial.print(bms_data.cell_max_mv);
+  Serial.print(" (#");
+  Serial.print(bms_data.cell_max_id);
+  Serial.print(") / ");
+  Serial.print(bms_data.cell_avg_mv);
+  Serial.print(", reported ");
+  Serial.print(bms_data.cells_reported);
+  Serial.print(", shunting ");
+  Serial.println(bms_data.cells_shunting);
+  Serial.print("  Thermistors max / avg (C): ");
+  Serial.print(bms_data.thermistor_max_c);
+  Serial.print(" (#");
+  Serial.print(bms_data.thermistor_max_id);
+  Serial.print(") / ");
+  Serial.print(bms_data.thermistor_avg_c);
+  Serial.print(", reported ");
+  Serial.println(bms_data.thermistors_reported);
+  Serial.print("  Torque Map: ");
+  Serial.print(torque_map_profile_name(torque_map_get_profile()));
+  if (torque_map_get_pending() != torque_map_get_profile()) {
+    Serial.print(" (pending ");
+    Serial.print(torque_map_profile_name(torque_map_get_pending()));
+    Serial.print(")");
+  }
+  Serial.println();
+  Serial.print("  Faults Active / Latched: 0x");
+  Serial.print(fault_manager.get_active(), HEX);
+  Serial.print(" / 0x");
+  Serial.println(fault_manager.get_latched(), HEX);
+  Serial.print("  Brake Pressure (Raw): ");
+  Serial.println(brakePressure);
+  Serial.print("  MPU Errors: ");
+  Serial.println(mpu_sampler_get_error_count());
+  Serial.print("  Error Inputs: 0x");
+  Serial.print(monitor_errors_get_word(), HEX);
+  Serial.print(" (critical edges: ");
+  Serial.print(monitor_errors_get_critical_edges());
+  Serial.println(")");
+  Serial.print("  Bamocar Status: 0x");
+  Serial.println(bamocar.getStatus(), HEX);
+  Serial.print("  Log Dropped / High Water (bytes): ");
+  Serial.print(logger_get_dropped_count());
+  Serial.print(" / ");
+  Serial.println(logger_get_high_water());
+  const DashStats &dash = dash_get_stats();
+  Serial.print("  Dash Sent / Unchanged / Deferred: ");
+  Serial.print(dash.commands_sent);
+  Serial.print(" / ");
+  Serial.print(dash.unchanged);
+  Serial.print(" / ");
+  Serial.println(dash.deferred);
+  // Add more debug info...
+  scheduler.print_stats();
+#ifdef VCU_TORQUE_ISR
+  torque_isr_print_stats();
+#endif
+#if VCU_PROFILING
+  profiler_print();
+#endif
+  Serial.println("------------------");
+}
+
+// Priority order (highest first). Phases spread the slower tasks across the
+// gaps between control releases instead of stacking them on one tick.
+// TODO: Re-check max runtimes (scheduler.print_stats()) after adding work.
+// Row 0 must stay "control" (setup() disables it when VCU_TORQUE_ISR is on).
+#define CONTROL_TASK_INDEX 0
+static const SchedulerTask tasks[] = {
+    // name, function, period_us, phase_us, deadline_us, enabled
+    {"control", task_control, 1000, 0, 500, true},                   // 1 kHz
+    {"decel_estimator", task_decel_estimator, 5000, 2500, 0, true},  // 200 Hz
+    {"brake_light", task_brake_light, 10000, 250, 0, true},          // 100 Hz
+    {"error_monitor", task_error_monitor, 10000, 500, 0, true},      // 100 Hz
+    {"bms_supervision", task_bms_supervision, 20000, 750, 0, true},  // 50 Hz
+    {"bamocar_requests", task_bamocar_requests, 200000, 1250, 0, true}, // 5 Hz
+    {"dashboard", task_dashboard, 50000, 1500, 0, true},             // 20 Hz
+    {"can_diagnostics", task_can_diagnostics, 100000, 1750, 0, true}, // 10 Hz
+    {"console", task_console, 100000, 2000, 0, true},                // 10 Hz
+    {"log_drain", task_log_drain, 5000, 1000, 0, true},              // 200 Hz
+    {"debug_status", task_debug_status, 1000000, 2250, 0, DEBUG_MODE >= 3},
+};
 
 //------------------------------------------------------------------------------
 // SETUP FUNCTION
 //------------------------------------------------------------------------------
 void setup() {
+  // DWT cycle counter for the profiler (off at reset; VCU_TORQUE_ISR builds
+  // call this again, which keeps the running count)
+  cycle_counter_init();
+
   // --- Initialize Serial Communication ---
   Serial.begin(115200); // Use a faster baud rate if possible
   while (!Serial && millis() < 5000)
@@ -38,9 +253,14 @@ void setup() {
   // Initialize Brake Pressure Sensor pin (analog input, no pinMode needed)
 
   // Initialize error monitoring pins
-  monitor_errors_setup(); // Sets pins 22-37 as INPUT
+  monitor_errors_setup(); // Pins 22-37 as INPUT, IMD/BSPD interrupts
 
   // --- Initialize CAN Communication ---
+  // Each node claims its RX IDs first; CANManager builds the hardware filters
+  // and dispatch table from those registrations.
+  bamocar.registerCANHandler(can_manager);
+  bms_handler.register_can_handlers(can_manager);
+
   // CANManager handles CAN0.begin() and filter setup
   if (!can_manager.initialize(CAN_BPS_500K)) {
     Serial.println("FATAL: CAN Initialization failed! Halting.");
@@ -49,21 +269,53 @@ void setup() {
   }
 
   // --- Initialize Sensors ---
-  // Initialize MPU6050 (if used, e.g., in brake_light.cpp)
-  // It's better to initialize here than in the loop function.
-  // Assuming brake_light.cpp has initializeMPU() made accessible or defined
-  // here
-  initializeMPU(); // Call the MPU init function
+  // APPS and brake pressure: free-running 12-bit ADC scan with DMA. No
+  // analogRead() calls after this point.
+  if (!adc_sampler_begin()) {
+    Serial.println("ERROR: ADC sampler failed to start! APPS will read as "
+                   "implausible.");
+  }
+
+  // MPU6050: accelerometer FIFO + data-ready interrupt, then read in the
+  // background by mpu_sampler_poll(). brake_light() runs without it if the
+  // sensor is missing.
+  mpu_sampler_begin();
+  // Deceleration for the brake light: MPU accelerometer + motor speed
+  decel_estimator_begin();
+  // Regen torque envelope (reciprocal table per speed bucket)
+  motor_control_begin();
 
-  // --- Initialize Dashboard (Optional) ---
-  // dash_setup(); // Uncomment if using Nextion display
+  // --- Initialize Dashboard ---
+  // Switches the Nextion to DASH_BAUD_RATE (updates: dashboard task)
+  dash_setup();
 
   // --- Initial Requests for Device Status (Optional) ---
   // Request initial status from Bamocar and BMS if needed at startup
-  // Note: Periodic requests are handled in motor_control_update()
+  // Note: Periodic requests are handled by the bamocar_requests task
   bamocar.requestStatus(INTVL_IMMEDIATE);
   // Add BMS initial requests if applicable/needed
 
+  // --- Start the Task Scheduler ---
+  // Anchors every task's release grid here; loop() only dispatches.
+  if (!scheduler.begin(tasks, sizeof(tasks) / sizeof(tasks[0]))) {
+    Serial.println("FATAL: Scheduler task table invalid! Halting.");
+    while (1)
+      ; // Halt execution
+  }
+
+#ifdef VCU_TORQUE_ISR
+  // --- Hardware-Timed Torque Control (Optional) ---
+  // The control tick moves to a timer interrupt with a fixed rate and
+  // measured worst case; the scheduler keeps only the background tasks.
+  // Falls back to the scheduler's control task if the timer cannot start.
+  if (torque_isr_begin(task_control, 1000)) {
+    scheduler.set_enabled(CONTROL_TASK_INDEX, false);
+  } else {
+    Serial.println("ERROR: Torque ISR failed to start! Using the scheduler "
+                   "control task.");
+  }
+#endif
+
   if (DEBUG_MODE) {
     Serial.println("--- Setup Complete ---");
   }
@@ -73,57 +325,15 @@ void setup() {
 // MAIN LOOP
 //------------------------------------------------------------------------------
 void loop() {
-  // --- 1. Process Incoming CAN Messages ---
-  // Reads messages from CAN buffer and dispatches to handlers (BMS, Bamocar)
-  can_manager.process_incoming_messages();
+  PROFILE_PERIOD(PROFILE_LOOP_PERIOD); // Gap since the previous pass
+  // Runs whichever tasks are due (see tasks[] above), highest priority first.
+  // Rates come from the task table, not from how long each pass takes.
+  scheduler.run_pending();
 
-  // --- 2. Read Sensors & Update Local States ---
-  // Reads brake pressure ADC, MPU6050 (if used), updates brake light state
-  brake_light(); // Updates global 'brakePressure' variable
-
-  // Monitor error input pins
-  monitor_errors_loop(); // Updates global errorXX flags
-
-  // --- 3. Execute Core Control Logic ---
-  // Reads APPS, performs safety checks (APPS plausibility, APPS/Brake, BMS
-  // status), determines final torque command, and sends it via CANManager. Also
-  // handles periodic CAN requests (status, temp) to Bamocar.
-  motor_control_update();
-
-  // --- 4. Update Dashboard (Optional) ---
-  // dash_loop(); // Uncomment if using Nextion display
-
-  // --- 5. Debug Output ---
-  if (DEBUG_MODE >= 3) { // Example: Higher debug level for less frequent output
-    static unsigned long last_debug_print = 0;
-    if (millis() - last_debug_print > 1000) { // Print status every second
-      Serial.println("--- Loop Status ---");
-      // Print key variables like APPS %, Brake Pressure, BMS SoC, Bamocar
-      // Status etc.
-      const BMSData &bms_data = bms_handler.get_bms_data();
-      Serial.print("  BMS SoC: ");
-      Serial.print(bms_data.pack_soc);
-      Serial.println("%");
-      Serial.print("  BMS Voltage: ");
-      Serial.print(bms_data.pack_voltage);
-      Serial.println(" V");
-      Serial.print("  BMS Fault: ");
-      Serial.println(bms_handler.has_critical_fault() ? "YES" : "NO");
-      Serial.print("  Brake Pressure (Raw): ");
-      Serial.println(brakePressure);
-      Serial.print("  Bamocar Status: 0x");
-      Serial.println(bamocar.getStatus(), HEX);
-      // Add more debug info...
-      last_debug_print = millis();
-      Serial.println("------------------");
-    }
+  // Accelerometer FIFO over I2C: one non-blocking step per pass, so the bus
+  // keeps moving between tasks without ever stalling one
+  {
+    PROFILE_SCOPE(PROFILE_MPU_READ);
+    mpu_sampler_poll();
   }
-
-  // --- Loop Timing ---
-  // Removed the blocking delay(800). The loop should run as fast as possible
-  // to ensure timely processing of CAN messages and control updates.
-  // If specific timing is needed for certain tasks, use non-blocking millis()
-  // checks. delayMicroseconds(100); // Optional: small delay to yield processor
-  // if needed, but generally avoid blocking delays.
-
 } // End of loop()
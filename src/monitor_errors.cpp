@@ -1,40 +1,92 @@
 /**
  * @file monitor_errors.cpp
- * @brief Monitors digital input pins (22-37) and sets corresponding global
- * error flags.
+ * @brief Samples the error input pins (22-37) into one fault word (see
+ * monitor_errors.h).
  * @author Shane Whelan (UCD Formula Student)
  * @date 2025-04-27
  */
 
-// TODO:
-// - Clearly define which physical error signal (e.g., IMD Fault, BSPD Fault)
-//   is connected to which specific digital input pin (22-37).
-// - Update motor_controller.cpp to check the relevant errorXX flags and trigger
-//   zero torque for critical faults.
-// - Consider using an array or bitmask for error flags instead of individual
-//   variables if managing many flags becomes cumbersome.
-
-#include "header.h" // Includes Arduino.h for pinMode, digitalRead
-
-// Declare individual global error flags (extern if declared in a header file)
-// These flags indicate the state (HIGH = 1, LOW = 0) of the corresponding pin.
-// TODO: Map these error numbers to specific fault conditions (IMD, BSPD, etc.)
-int error22 = 0;
-int error23 = 0;
-int error24 = 0;
-int error25 = 0;
-int error26 = 0;
-int error27 = 0;
-int error28 = 0;
-int error29 = 0;
-int error30 = 0;
-int error31 = 0;
-int error32 = 0;
-int error33 = 0;
-int error34 = 0;
-int error35 = 0;
-int error36 = 0;
-int error37 = 0;
+#include "monitor_errors.h"
+#include "header.h"
+#include "logger.h"
+#include <string.h> // For memset
+
+static_assert(ERROR_PIN_END - ERROR_PIN_START + 1 == ERROR_INPUT_COUNT,
+              "Fault word must cover ERROR_PIN_START..ERROR_PIN_END");
+
+static volatile uint16_t error_word = 0;
+static volatile uint32_t critical_edges = 0;
+static uint16_t reported_word = 0; // Last word logged / transmitted
+static uint32_t last_status_ms = 0;
+
+//------------------------------------------------------------------------------
+// Sampling
+//------------------------------------------------------------------------------
+#if defined(ARDUINO_ARCH_SAM)
+// Pins 22-37 are spread over PIOA-PIOD: each port's PDSR is read once, then
+// every pin's bit is picked out with the mask from the core's pin table.
+#define ERROR_NUM_PORTS 4
+static Pio *const error_ports[ERROR_NUM_PORTS] = {PIOA, PIOB, PIOC, PIOD};
+static uint8_t pin_port[ERROR_INPUT_COUNT]; // Index into error_ports
+static uint32_t pin_mask[ERROR_INPUT_COUNT];
+
+static void map_error_pins() {
+  for (uint8_t i = 0; i < ERROR_INPUT_COUNT; i++) {
+    const PinDescription &pin = g_APinDescription[ERROR_INPUT_FIRST_PIN + i];
+    for (uint8_t p = 0; p < ERROR_NUM_PORTS; p++) {
+      if (error_ports[p] == pin.pPort)
+        pin_port[i] = p;
+    }
+    pin_mask[i] = pin.ulPin;
+  }
+}
+
+static uint16_t read_error_word() {
+  uint32_t pdsr[ERROR_NUM_PORTS];
+  for (uint8_t p = 0; p < ERROR_NUM_PORTS; p++) {
+    pdsr[p] = error_ports[p]->PIO_PDSR; // Needs the PIO clock (pinMode INPUT)
+  }
+  uint16_t word = 0;
+  for (uint8_t i = 0; i < ERROR_INPUT_COUNT; i++) {
+    if (pdsr[pin_port[i]] & pin_mask[i])
+      word |= (uint16_t)(1u << i);
+  }
+  return word;
+}
+#else // Host build: digitalRead() returns the scripted inputs
+static void map_error_pins() {}
+
+static uint16_t read_error_word() {
+  uint16_t word = 0;
+  for (uint8_t i = 0; i < ERROR_INPUT_COUNT; i++) {
+    if (digitalRead(ERROR_INPUT_FIRST_PIN + i) == HIGH)
+      word |= (uint16_t)(1u << i);
+  }
+  return word;
+}
+#endif
+
+// Pin-change interrupt of the critical lines
+static void critical_line_changed() {
+  error_word = read_error_word();
+  critical_edges++;
+}
+
+static void send_status_frame(uint16_t word) {
+  uint32_t edges = critical_edges;
+  uint16_t edges_16 = edges > 0xFFFF ? 0xFFFF : (uint16_t)edges;
+
+  CAN_FRAME frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.id = ERROR_STATUS_TX_ID;
+  frame.extended = false;
+  frame.length = 4;
+  frame.data.bytes[0] = word & 0xFF;
+  frame.data.bytes[1] = word >> 8;
+  frame.data.bytes[2] = edges_16 & 0xFF;
+  frame.data.bytes[3] = edges_16 >> 8;
+  can_manager.send_message(frame, CAN_TX_PRIORITY_TELEMETRY, 0);
+}
 
 //------------------------------------------------------------------------------
 // Setup function for error monitoring pins
@@ -48,6 +100,13 @@ void monitor_errors_setup() {
   for (int pin = ERROR_PIN_START; pin <= ERROR_PIN_END; pin++) {
     pinMode(pin, INPUT); // Set each pin as a digital input
   }
+  map_error_pins();
+  error_word = read_error_word();
+
+  for (uint8_t i = 0; i < ERROR_INPUT_COUNT; i++) {
+    if (ERROR_CRITICAL_MASK & (1u << i))
+      attachInterrupt(ERROR_INPUT_FIRST_PIN + i, critical_line_changed, CHANGE);
+  }
   if (DEBUG_MODE) {
     Serial.println("Error monitoring pins (22-37) initialized as inputs.");
   }
@@ -57,69 +116,31 @@ void monitor_errors_setup() {
 // Loop function to read error monitoring pins
 //------------------------------------------------------------------------------
 /**
- * @brief Reads the state of digital pins 22 through 37 and updates
- * the corresponding global errorXX flag.
- * Called repeatedly from the main loop() function.
+ * @brief Re-samples pins 22 through 37 into the fault word and reports it
+ * when it changes.
+ * Called from the error_monitor task.
  */
 void monitor_errors_loop() {
-  // Loop through the defined range of error monitoring pins
-  for (int pin = ERROR_PIN_START; pin <= ERROR_PIN_END; pin++) {
-    int state = digitalRead(pin); // Read the current state of the pin
-
-    // Update the corresponding global error flag based on the pin number
-    // A HIGH state on the pin sets the flag to 1, LOW sets it to 0.
-    switch (pin) {
-    case 22:
-      error22 = (state == HIGH) ? 1 : 0;
-      break;
-    case 23:
-      error23 = (state == HIGH) ? 1 : 0;
-      break;
-    case 24:
-      error24 = (state == HIGH) ? 1 : 0;
-      break;
-    case 25:
-      error25 = (state == HIGH) ? 1 : 0;
-      break;
-    case 26:
-      error26 = (state == HIGH) ? 1 : 0;
-      break;
-    case 27:
-      error27 = (state == HIGH) ? 1 : 0;
-      break;
-    case 28:
-      error28 = (state == HIGH) ? 1 : 0;
-      break;
-    case 29:
-      error29 = (state == HIGH) ? 1 : 0;
-      break;
-    case 30:
-      error30 = (state == HIGH) ? 1 : 0;
-      break;
-    case 31:
-      error31 = (state == HIGH) ? 1 : 0;
-      break;
-    case 32:
-      error32 = (state == HIGH) ? 1 : 0;
-      break;
-    case 33:
-      error33 = (state == HIGH) ? 1 : 0;
-      break;
-    case 34:
-      error34 = (state == HIGH) ? 1 : 0;
-      break;
-    case 35:
-      error35 = (state == HIGH) ? 1 : 0;
-      break;
-    case 36:
-      error36 = (state == HIGH) ? 1 : 0;
-      break;
-    case 37:
-      error37 = (state == HIGH) ? 1 : 0;
-      break;
-      // Add cases if pin range changes
-    }
+  uint16_t word;
+  {
+    // The critical-line interrupt also writes the word: without the lock it
+    // could land between our read and store and be overwritten
+    CriticalSection lock;
+    word = read_error_word();
+    error_word = word;
   }
-  // Optional: Add debug printing here if needed to see flag states
-  // if (DEBUG_MODE >= 2) { ... print errorXX values ... }
+
+  uint32_t now = millis();
+  if (word != reported_word) {
+    log_event<LOG_ERROR_INPUTS_CHANGED>(word, word ^ reported_word);
+  } else if (now - last_status_ms < ERROR_STATUS_PERIOD_MS) {
+    return;
+  }
+  reported_word = word;
+  last_status_ms = now;
+  send_status_frame(word);
 }
+
+uint16_t monitor_errors_get_word() { return error_word; }
+
+uint32_t monitor_errors_get_critical_edges() { return critical_edges; }
@@ -8,10 +8,6 @@
  */
 
 // TODO:
-// - Implement checks for critical error pins (IMD, BSPD faults, etc.) in
-// section 5
-//   of motor_control_update(). Define which pins correspond to which faults
-//   and ensure they trigger zero torque when active.
 // - Verify the logic for clearing latched fault states (APPS plausibility,
 // APPS/Brake)
 //   matches FSUK rule requirements (e.g., requiring LVMS cycle for some
@@ -25,29 +21,117 @@
 // regen (Rule T6.3.1).
 
 #include "bamocar-due.h" // Bamocar library interface
-#include "bms_handler.h" // To get BMS status for safety checks
+#include "bms_handler.h"   // To get BMS status for safety checks
+#include "fault_manager.h" // Fault state, torque gating and history
 #include "header.h"
+#include "logger.h"  // Binary event log (non-blocking)
 #include <Arduino.h> // For millis(), PI
-#include <cmath>     // For std::fabs
 
 // Define the global Bamocar instance (used by CANManager and potentially
 // elsewhere)
 Bamocar bamocar;
 
-// State variables for safety checks
-static bool apps_implausibility_active = false;
-static unsigned long apps_implausibility_start_time = 0;
-static bool apps_brake_implausibility_active = false;
-static unsigned long apps_brake_implausibility_start_time = 0;
-
-// Regen Configuration
+// Regen Configuration (Q15 fractions; the control path is integer-only)
 // TODO: Calibrate this value for desired off-throttle braking feel
-const float REGEN_DESIRED_TORQUE_FRACTION =
-    -0.15f; // e.g., -15% torque for regen
-const float APPS_REGEN_THRESHOLD =
-    5.0f; // APPS % below which off-throttle regen is considered
-const float MIN_SPEED_FOR_REGEN_RPM =
-    100.0f; // Minimum motor RPM to apply regen (prevent issues at stall)
+const q15_t REGEN_DESIRED_TORQUE_Q15 =
+    Q15_FROM_FLOAT(-0.15); // e.g., -15% torque for regen
+const q15_t APPS_REGEN_THRESHOLD_Q15 =
+    Q15_FROM_FLOAT(0.05); // APPS below which off-throttle regen is considered
+const int32_t MIN_SPEED_FOR_REGEN_RPM =
+    100; // Minimum motor RPM to apply regen (prevent issues at stall)
+const q15_t APPS_BRAKE_CLEAR_THRESHOLD_Q15 =
+    Q15_FROM_FLOAT(0.05); // APPS must drop below 5% to clear (Rule EV.2.3.2)
+
+// Regen torque limit: T[Nm] = P[W] / w[rad/s] = P * 60 / (2 * PI * rpm).
+// Computed in Nm x 256; the factor is rounded down so the limit errs low.
+#define REGEN_TORQUE_FRAC_BITS 8
+const int32_t REGEN_NM_X256_PER_W_RPM =
+    (int32_t)(60.0 * (1 << REGEN_TORQUE_FRAC_BITS) / (2.0 * PI));
+// Above this power the limit is full scale at any reachable speed anyway;
+// clamping keeps power * factor inside int32_t.
+const int32_t REGEN_POWER_CLAMP_W = 800000;
+
+// Regen envelope: the limit is cached per speed bucket and only recomputed
+// when the bucket or the BMS charge power changes. Speeds past the last
+// bucket fall back to regen_torque_limit_q15().
+#define REGEN_RPM_BUCKET_SHIFT 6 // 64 RPM per bucket
+#define REGEN_RPM_BUCKETS 128    // Covers 0-8191 RPM
+#define REGEN_RECIP_SHIFT 28
+#define REGEN_DEFAULT_MAX_TORQUE_NM 80 // If getMaxTorqueNm() has no value
+
+//------------------------------------------------------------------------------
+// Regen Torque Limit
+//------------------------------------------------------------------------------
+/**
+ * @brief Largest regen torque the pack can absorb at the given speed, as a
+ * fraction of the motor's maximum torque. Integer-only: two hardware divides.
+ * @param power_w Maximum charge power (CCL x pack voltage) in W.
+ * @param speed_rpm Motor speed in RPM (> 0).
+ * @param max_torque_nm Motor maximum torque in Nm (> 0).
+ * @return Torque limit as a positive Q15 fraction (0 to Q15_ONE).
+ */
+q15_t regen_torque_limit_q15(int32_t power_w, int32_t speed_rpm,
+                             int32_t max_torque_nm) {
+  if (power_w <= 0 || speed_rpm <= 0 || max_torque_nm <= 0)
+    return 0;
+  if (power_w > REGEN_POWER_CLAMP_W)
+    power_w = REGEN_POWER_CLAMP_W;
+
+  int32_t torque_x256 = (power_w * REGEN_NM_X256_PER_W_RPM) / speed_rpm;
+  if (torque_x256 >= (max_torque_nm << REGEN_TORQUE_FRAC_BITS))
+    return Q15_ONE;
+  // Nm x 256 -> fraction of max torque in Q15 (x 32768 / 256 = x 128)
+  return (q15_t)((torque_x256 << (15 - REGEN_TORQUE_FRAC_BITS)) /
+                 max_torque_nm);
+}
+
+//------------------------------------------------------------------------------
+// Regen Torque Envelope
+//------------------------------------------------------------------------------
+// Q15 limit per W of charge power for each bucket, in 2^-REGEN_RECIP_SHIFT:
+// 2^(shift + 7) / (rpm * max torque), using the bucket's top RPM and rounded
+// down. The limit falls with speed, so the top edge is the conservative one.
+static uint32_t regen_recip[REGEN_RPM_BUCKETS];
+static int32_t regen_max_torque_nm = REGEN_DEFAULT_MAX_TORQUE_NM;
+
+// Last computed limit and what it was computed for
+static int32_t regen_cached_power_w = -1;
+static uint16_t regen_cached_bucket = 0;
+static q15_t regen_cached_limit_q15 = 0;
+
+void motor_control_begin() {
+  // TODO: Implement/Verify bamocar.getMaxTorqueNm() or use constant
+  regen_max_torque_nm = (int32_t)bamocar.getMaxTorqueNm();
+  if (regen_max_torque_nm <= 0)
+    regen_max_torque_nm = REGEN_DEFAULT_MAX_TORQUE_NM;
+
+  for (uint16_t bucket = 0; bucket < REGEN_RPM_BUCKETS; bucket++) {
+    uint32_t top_rpm = (uint32_t)(bucket + 1) << REGEN_RPM_BUCKET_SHIFT;
+    regen_recip[bucket] = (uint32_t)((1ULL << (REGEN_RECIP_SHIFT + 7)) /
+                                     (top_rpm * regen_max_torque_nm));
+  }
+  regen_cached_power_w = -1; // Force a recompute on first use
+}
+
+q15_t regen_envelope_q15(int32_t power_w, int32_t speed_rpm) {
+  if (power_w <= 0 || speed_rpm <= 0)
+    return 0;
+  uint32_t bucket = (uint32_t)speed_rpm >> REGEN_RPM_BUCKET_SHIFT;
+  if (bucket >= REGEN_RPM_BUCKETS)
+    return regen_torque_limit_q15(power_w, speed_rpm, regen_max_torque_nm);
+  if (power_w == regen_cached_power_w && bucket == regen_cached_bucket)
+    return regen_cached_limit_q15;
+
+  int32_t clamped_w =
+      power_w > REGEN_POWER_CLAMP_W ? REGEN_POWER_CLAMP_W : power_w;
+  uint64_t limit = ((uint64_t)(clamped_w * REGEN_NM_X256_PER_W_RPM) *
+                    regen_recip[bucket]) >>
+                   REGEN_RECIP_SHIFT;
+  regen_cached_power_w = power_w;
+  regen_cached_bucket = (uint16_t)bucket;
+  regen_cached_limit_q15 = limit >= Q15_ONE ? Q15_ONE : (q15_t)limit;
+  return regen_cached_limit_q15;
+}
 
 //------------------------------------------------------------------------------
 // Motor Control Update Function
@@ -57,228 +141,159 @@ const float MIN_SPEED_FOR_REGEN_RPM =
  * Reads APPS, performs safety checks (APPS Plausibility, APPS/Brake, BMS),
  * calculates desired torque (positive or negative for regen), limits regen
  * based on BMS CCL, and sends the appropriate torque command to the Bamocar.
- * This should be called repeatedly in the main loop.
+ * Called by the scheduler's control task at a fixed 1 kHz.
  */
 void motor_control_update() {
-  double torque_request_percent =
-      0.0; // APPS reading (0-100) or -1.0 if implausible
-  bool send_zero_torque =
-      false; // Flag to force sending zero torque due to faults
-  float final_torque_fraction = 0.0f; // Final command (-1.0 to 1.0)
+  q15_t torque_request_q15 = 0; // APPS reading (0 to Q15_ONE) or -1
+  q15_t final_torque_q15 = 0;   // Final command (Q15, -1.0 to 1.0)
 
   // --- 1. Read APPS Sensor ---
-  torque_request_percent = get_apps_reading();
+  // APPS and brake pressure come from one ADC scan, so the plausibility checks
+  // below compare samples taken microseconds apart. No scan yet = implausible.
+  AdcSnapshot adc;
+  bool adc_valid = adc_sampler_read(adc);
+  torque_request_q15 = adc_valid ? get_apps_reading_q15(adc) : (q15_t)-1;
+
+  // Sections 2-5 only report conditions; fault_manager keeps the state,
+  // timestamps and transition history, and gates torque in section 6.
 
   // --- 2. APPS Plausibility Check (Rule EV.5.6) ---
-  if (torque_request_percent < 0.0) { // Implausibility detected
-    if (!apps_implausibility_active) {
-      apps_implausibility_active = true;
-      apps_implausibility_start_time = millis();
-      if (DEBUG_MODE)
-        Serial.println("MOTOR CTRL: APPS Plausibility Fault Started.");
-    }
-    if (millis() - apps_implausibility_start_time >=
-        APPS_PLAUSIBILITY_TIMEOUT_MS) {
-      send_zero_torque = true;
-      if (DEBUG_MODE)
-        Serial.println(
-            "MOTOR CTRL: APPS Plausibility Timeout - Zero Torque Latched.");
-      // TODO: Consider LVMS cycle requirement for reset
-    } else {
-      send_zero_torque = true; // Immediate zero torque within timeout
-    }
-  } else { // APPS Plausible
-    if (apps_implausibility_active) {
-      if (DEBUG_MODE)
-        Serial.println("MOTOR CTRL: APPS Plausibility Fault Cleared.");
-      // TODO: Verify reset logic if latching requires LVMS cycle
-    }
-    apps_implausibility_active = false;
-  }
+  // Zero torque for as long as the sensors disagree (the rule allows up to
+  // APPS_PLAUSIBILITY_TIMEOUT_MS)
+  // TODO: Consider LVMS cycle requirement for reset
+  fault_manager.set(FAULT_APPS_IMPLAUSIBLE, torque_request_q15 < 0);
 
   // --- 3. APPS / Brake Plausibility Check (Rule EV.2.3.1 / EV.5.7) ---
-  bool brake_active = (brakePressure > BRAKE_LIGHT_THRESHOLD);
-  // Use plausible APPS value for this check, default to 0 if implausible but
-  // not yet timed out
-  double apps_for_brake_check =
-      (torque_request_percent >= 0.0) ? torque_request_percent : 0.0;
-
-  if (!send_zero_torque && brake_active &&
-      apps_for_brake_check > APPS_BRAKE_PLAUSIBILITY_THRESHOLD) {
-    if (!apps_brake_implausibility_active) {
-      apps_brake_implausibility_active = true;
-      apps_brake_implausibility_start_time = millis();
-      if (DEBUG_MODE)
-        Serial.println("MOTOR CTRL: APPS/Brake Plausibility Fault Started.");
-    }
-    if (millis() - apps_brake_implausibility_start_time >=
-        APPS_BRAKE_PLAUSIBILITY_TIMEOUT_MS) {
-      send_zero_torque = true;
-      if (DEBUG_MODE)
-        Serial.println("MOTOR CTRL: APPS/Brake Plausibility Timeout - Zero "
-                       "Torque Latched.");
-    } else {
-      send_zero_torque = true; // Immediate zero torque
-    }
-  } else { // Condition not met OR condition cleared
-    if (apps_brake_implausibility_active) {
-      // Only clear if APPS < 5% (Rule EV.2.3.2)
-      if (torque_request_percent >= 0.0 && torque_request_percent < 5.0) {
-        apps_brake_implausibility_active = false;
-        if (DEBUG_MODE)
-          Serial.println(
-              "MOTOR CTRL: APPS/Brake Plausibility Fault Cleared (APPS < 5%).");
-      } else {
-        // Still braking or APPS > 5%, keep forcing zero torque if latched
-        if (millis() - apps_brake_implausibility_start_time >=
-            APPS_BRAKE_PLAUSIBILITY_TIMEOUT_MS) {
-          send_zero_torque = true;
-          if (DEBUG_MODE >= 2)
-            Serial.println("MOTOR CTRL: APPS/Brake Fault Active, APPS >= 5%");
-        }
-      }
-    }
-    // If fault wasn't latched (i.e. just started), it clears immediately when
-    // condition is no longer met.
-  }
+  bool brake_active =
+      adc_valid && (adc.brake_pressure > BRAKE_LIGHT_THRESHOLD);
+  // Use plausible APPS value for this check, 0 if implausible
+  q15_t apps_for_brake_check =
+      (torque_request_q15 >= 0) ? torque_request_q15 : 0;
+  // Once set, stays until APPS < 5%, brake on or not (Rule EV.2.3.2)
+  bool apps_released = torque_request_q15 >= 0 &&
+                       torque_request_q15 < APPS_BRAKE_CLEAR_THRESHOLD_Q15;
+  fault_manager.set(
+      FAULT_APPS_BRAKE,
+      (brake_active &&
+       apps_for_brake_check > APPS_BRAKE_PLAUSIBILITY_THRESHOLD_Q15) ||
+          (fault_manager.is_active(FAULT_APPS_BRAKE) && !apps_released));
 
   // --- 4. Check BMS Status (Rule EV5.8) ---
-  const BMSData &bms_data = bms_handler.get_bms_data();
-  // TODO: Ensure bms_handler.has_critical_fault() is correctly implemented
-  if (!send_zero_torque && (bms_handler.has_critical_fault() ||
-                            !bms_handler.is_communication_active())) {
-    send_zero_torque = true;
-    if (DEBUG_MODE) {
-      if (bms_handler.has_critical_fault())
-        Serial.println(
-            "MOTOR CTRL: BMS Critical Fault Detected - Zero Torque.");
-      if (!bms_handler.is_communication_active(1000))
-        Serial.println("MOTOR CTRL: BMS Communication Lost - Zero Torque.");
+  // One coherent copy for the fault check and the regen limit below, so CCL
+  // and pack voltage always come from the same publish. Re-copied only when
+  // the BMS generation moves.
+  static BMSData bms_data;
+  static bool bms_data_valid = false;
+  static int32_t max_regen_power = 0; // W, CCL x pack voltage of bms_data
+  if (!bms_data_valid || bms_handler.get_generation() != bms_data.generation) {
+    BMSData fresh;
+    if (bms_handler.read_snapshot(fresh)) {
+      bms_data = fresh;
+      bms_data_valid = true;
+      // Truncated to whole A / V, so the limit errs low
+      int32_t current_ccl = (int32_t)bms_data.charge_current_limit; // Amps
+      int32_t pack_voltage = (int32_t)bms_data.pack_voltage;        // Volts
+      max_regen_power = (current_ccl > 0 && pack_voltage > 0)
+                            ? current_ccl * pack_voltage
+                            : 0;
     }
   }
+  // TODO: Ensure BMSHandler::has_critical_fault() is correctly implemented
+  fault_manager.set(FAULT_BMS_CRITICAL,
+                    !bms_data_valid ||
+                        BMSHandler::has_critical_fault(bms_data));
+  fault_manager.set(FAULT_BMS_COMM_LOST,
+                    !bms_handler.is_communication_active());
 
   // --- 5. Check Monitored Error Pins ---
-  // TODO: Implement checks for critical error signals (IMD, BSPD faults, etc.)
-  // Example:
-  // extern int error22; // IMD_FAULT_PIN
-  // extern int error23; // BSPD_FAULT_PIN
-  // if (!send_zero_torque && error22 == 1) {
-  //     send_zero_torque = true;
-  //     if (DEBUG_MODE) Serial.println("MOTOR CTRL: IMD Fault Active - Zero
-  //     Torque.");
-  // }
-  // if (!send_zero_torque && error23 == 1) {
-  //     send_zero_torque = true;
-  //     if (DEBUG_MODE) Serial.println("MOTOR CTRL: BSPD Fault Active - Zero
-  //     Torque.");
-  // }
+  // IMD / BSPD refresh the fault word from their pin-change interrupt, so a
+  // fault is seen here on the first tick after the edge.
+  uint16_t critical_errors = monitor_errors_get_critical();
+  fault_manager.set(FAULT_IMD,
+                    (critical_errors & ERROR_BIT(IMD_FAULT_PIN)) != 0);
+  fault_manager.set(FAULT_BSPD,
+                    (critical_errors & ERROR_BIT(BSPD_FAULT_PIN)) != 0);
 
   // --- 6. Determine Torque Command (Acceleration or Regen) ---
-  if (send_zero_torque) {
-    final_torque_fraction = 0.0f;
-  } else if (torque_request_percent < APPS_REGEN_THRESHOLD) {
+  // A torque map picked on the console takes effect only off throttle or
+  // with torque inhibited, never as a step under a pressed pedal
+  if (torque_request_q15 < APPS_REGEN_THRESHOLD_Q15 ||
+      fault_manager.torque_inhibited())
+    torque_map_apply_pending();
+
+  if (fault_manager.torque_inhibited()) {
+    final_torque_q15 = 0;
+  } else if (torque_request_q15 < APPS_REGEN_THRESHOLD_Q15) {
     // --- Off-Throttle Regen Logic ---
-    float motor_speed_rpm = bamocar.getSpeed(); // Get speed in RPM
+    int32_t motor_speed_rpm = bamocar.getSpeedRpm(); // Get speed in RPM
 
     // Only apply regen if speed is sufficient and no faults active
     if (motor_speed_rpm > MIN_SPEED_FOR_REGEN_RPM) {
-      // Get Limits from BMS
-      float current_ccl = bms_data.charge_current_limit; // Amps
-      float pack_voltage = bms_data.pack_voltage;        // Volts
+      // Basic check for valid BMS data (CCL and pack voltage both > 0)
+      if (max_regen_power > 0) {
+        // Limit the desired regen torque by the torque the pack can absorb
+        // at this speed: a cached lookup unless the BMS limits or the speed
+        // bucket moved. Ensure final torque is negative or zero
+        q15_t max_regen_torque_limit =
+            regen_envelope_q15(max_regen_power, motor_speed_rpm);
+        final_torque_q15 = (REGEN_DESIRED_TORQUE_Q15 > -max_regen_torque_limit)
+                               ? REGEN_DESIRED_TORQUE_Q15
+                               : (q15_t)-max_regen_torque_limit;
 
-      // Basic check for valid BMS data
-      if (current_ccl > 0 && pack_voltage > 0) {
-        // Calculate Max Regen Power based on CCL
-        float max_regen_power = current_ccl * pack_voltage; // Watts
-
-        // Calculate Max Regen Torque based on Power and Speed
-        // Power = Torque (Nm) * Speed (rad/s)
-        // TODO: Verify this conversion factor if needed
-        float motor_speed_rad_s = motor_speed_rpm * (2.0f * PI / 60.0f);
-        float max_regen_torque_limit = 0.0f;
-        if (std::fabs(motor_speed_rad_s) >
-            0.1f) { // Avoid division by zero/tiny numbers
-          max_regen_torque_limit =
-              max_regen_power / std::fabs(motor_speed_rad_s);
-        }
-
-        // Limit the desired regen torque by the calculated max allowed torque
-        // Ensure final torque is negative or zero
-        // TODO: Implement/Verify bamocar.getMaxTorqueNm() or use constant
-        float max_motor_torque = bamocar.getMaxTorqueNm();
-        if (max_motor_torque <= 0)
-          max_motor_torque =
-              80.0f; // Safety default if function fails/not implemented
-        final_torque_fraction = max(REGEN_DESIRED_TORQUE_FRACTION,
-                                    -max_regen_torque_limit / max_motor_torque);
-
-        if (DEBUG_MODE >= 2) {
-          Serial.print("Regen Calc: Desired=");
-          Serial.print(REGEN_DESIRED_TORQUE_FRACTION);
-          Serial.print(", CCL=");
-          Serial.print(current_ccl);
-          Serial.print(", Vpack=");
-          Serial.print(pack_voltage);
-          Serial.print(", RPM=");
-          Serial.print(motor_speed_rpm);
-          Serial.print(", MaxP=");
-          Serial.print(max_regen_power);
-          Serial.print(", MaxT_Nm=");
-          Serial.print(max_regen_torque_limit);
-          Serial.print(", FinalT_Frac=");
-          Serial.println(final_torque_fraction);
-        }
+        log_event<LOG_MOTOR_REGEN_CALC>(max_regen_power, motor_speed_rpm,
+                                        max_regen_torque_limit,
+                                        final_torque_q15);
 
       } else {
         // Invalid BMS data for calculation, default to zero regen
-        final_torque_fraction = 0.0f;
-        if (DEBUG_MODE)
-          Serial.println(
-              "MOTOR CTRL: Regen skipped - Invalid BMS CCL/Voltage data.");
+        final_torque_q15 = 0;
+        log_event<LOG_MOTOR_REGEN_INVALID_BMS>();
       }
     } else {
       // Speed too low for regen
-      final_torque_fraction = 0.0f;
-      if (DEBUG_MODE >= 2)
-        Serial.println("MOTOR CTRL: Regen skipped - Speed too low.");
+      final_torque_q15 = 0;
+      log_event<LOG_MOTOR_REGEN_LOW_SPEED>();
     }
 
   } else {
     // --- Acceleration Logic ---
-    // APPS is pressed and no faults active
-    final_torque_fraction = torque_request_percent / 100.0f;
-    // Clamp just in case
-    final_torque_fraction = constrain(final_torque_fraction, 0.0f, 1.0f);
+    // APPS is pressed and no faults active: pedal (0 to Q15_ONE) and motor
+    // speed through the active driver profile's torque map
+    final_torque_q15 =
+        torque_map_lookup_q15(torque_request_q15, bamocar.getSpeedRpm());
   }
 
-  // Final safety clamp
-  final_torque_fraction = constrain(final_torque_fraction, -1.0f, 1.0f);
-
   // --- 7. Send Torque Command to Bamocar ---
-  if (!bamocar.setTorque(final_torque_fraction)) {
-    if (DEBUG_MODE) {
-      Serial.println(
-          "MOTOR CTRL: Failed to send torque command via CANManager.");
-    }
+  if (!bamocar.setTorqueQ15(final_torque_q15)) {
+    log_event<LOG_MOTOR_TORQUE_SEND_FAILED>();
   }
 
-  if (DEBUG_MODE) {
-    Serial.print("MOTOR CTRL: Final Torque Command: ");
-    Serial.print(final_torque_fraction * 100.0, 1);
-    Serial.println("%");
+  // Logged when it changes: every tick would be 12 kB/s, more than the link
+  static q15_t last_logged_torque_q15 = 0;
+  if (log_event_enabled(LOG_MOTOR_TORQUE_COMMAND) &&
+      final_torque_q15 != last_logged_torque_q15) {
+    log_event<LOG_MOTOR_TORQUE_COMMAND>(q15_to_permille(final_torque_q15));
+    last_logged_torque_q15 = final_torque_q15;
   }
+}
 
-  // --- 8. Request Feedback from Bamocar (Periodic) ---
-  static unsigned long last_status_request_time = 0;
-  unsigned long now = millis();
-  // TODO: Adjust request frequency as needed
-  if (now - last_status_request_time > 200) { // Request status every 200ms
-    bamocar.requestStatus(INTVL_IMMEDIATE);
-    bamocar.requestMotorTemp(INTVL_IMMEDIATE);
-    bamocar.requestControllerTemp(INTVL_IMMEDIATE);
-    bamocar.requestSpeed(
-        INTVL_IMMEDIATE); // Request speed needed for regen calc
-    // Add other requests as needed
-    last_status_request_time = now;
-  }
+//------------------------------------------------------------------------------
+// Bamocar Feedback Requests
+//------------------------------------------------------------------------------
+/**
+ * @brief Requests status, temperatures and speed (needed for the regen
+ * calculation) from the Bamocar. Run periodically by the scheduler
+ * (bamocar_requests task, 5 Hz); previously a 200 ms millis() check inside
+ * motor_control_update().
+ */
+void motor_control_request_feedback() {
+  // TODO: Adjust request frequency as needed (task period in main.cpp)
+  bamocar.requestStatus(INTVL_IMMEDIATE);
+  bamocar.requestMotorTemp(INTVL_IMMEDIATE);
+  bamocar.requestControllerTemp(INTVL_IMMEDIATE);
+  // Speed (regen calc, deceleration estimate) comes cyclically every
+  // DECEL_SPEED_INTERVAL_MS; repeating the request re-arms it after a
+  // Bamocar reset
+  bamocar.requestSpeed(DECEL_SPEED_INTERVAL_MS);
+  // Add other requests as needed
 }
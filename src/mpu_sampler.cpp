@@ -0,0 +1,351 @@
+/**
+ * @file mpu_sampler.cpp
+ * @brief Implements non-blocking MPU6050 accelerometer acquisition (see
+ * mpu_sampler.h): FIFO + data-ready configuration at start-up, then a polled
+ * TWI/PDC state machine that never waits on the bus. Host builds publish
+ * the native HAL's scripted acceleration at the same rate.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "mpu_sampler.h"
+#include "header.h"
+#include <string.h> // For memset
+
+// MPU6050 registers (RM-MPU-6000A)
+#define MPU_ADDRESS 0x68
+#define MPU_REG_SMPLRT_DIV 0x19
+#define MPU_REG_FIFO_EN 0x23
+#define MPU_REG_INT_PIN_CFG 0x37
+#define MPU_REG_INT_ENABLE 0x38
+#define MPU_REG_USER_CTRL 0x6A
+#define MPU_REG_FIFO_COUNTH 0x72
+#define MPU_REG_FIFO_R_W 0x74
+
+#define MPU_FIFO_EN_ACCEL 0x08     // FIFO_EN: accelerometer X/Y/Z only
+#define MPU_INT_DATA_RDY 0x01      // INT_ENABLE: data ready
+#define MPU_USER_CTRL_FIFO_EN 0x40 // USER_CTRL: FIFO on
+#define MPU_USER_CTRL_FIFO_RESET 0x04
+#define MPU_FIFO_SIZE 1024
+#define MPU_FIFO_SAMPLE_BYTES 6 // XH XL YH YL ZH ZL
+
+#define MPU_STANDARD_GRAVITY_MM_S2 9807
+
+// Newest sample. mpu_sampler_poll() and the readers both run from loop(), so
+// no lock is needed; only the data-ready flag comes from an interrupt.
+static MpuSample published;
+static bool sampler_started = false;
+static uint32_t error_count = 0;
+
+// Blocking register write over Wire; setup() only
+static bool write_register(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(MPU_ADDRESS);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+#if defined(ARDUINO_ARCH_SAM)
+//------------------------------------------------------------------------------
+// SAM3X: Polled TWI1 Transfers with the PDC
+//------------------------------------------------------------------------------
+// Wire (TWI1) owns TWI1_Handler, so transfers are advanced by polling the
+// status register. The master holds SCL while a received byte is unread, so
+// a late poll only stretches the transfer; it never loses data.
+enum TwiPhase {
+  TWI_IDLE,
+  TWI_RX_PDC,         // PDC receiving all but the last two bytes
+  TWI_RX_PENULTIMATE, // STOP goes out with the next byte
+  TWI_RX_LAST,
+  TWI_WAIT_COMPLETE // TXCOMP ends every transfer
+};
+
+enum TwiResult { TWI_BUSY, TWI_DONE, TWI_FAILED };
+
+static TwiPhase twi_phase = TWI_IDLE;
+static uint8_t *twi_buffer;
+static uint8_t twi_length;
+static uint8_t twi_received;
+static uint32_t twi_start_us;
+
+static void twi_abort() {
+  TWI1->TWI_PTCR = TWI_PTCR_RXTDIS | TWI_PTCR_TXTDIS;
+  TWI1->TWI_CR = TWI_CR_STOP;
+  (void)TWI1->TWI_RHR;
+  twi_phase = TWI_IDLE;
+}
+
+// Starts a burst read of length bytes from reg (SAM3X datasheet, TWI "Read
+// Sequence with PDC": the PDC takes length - 2, the last two by hand)
+static void twi_start_read(uint8_t reg, uint8_t *buffer, uint8_t length) {
+  TWI1->TWI_PTCR = TWI_PTCR_RXTDIS | TWI_PTCR_TXTDIS;
+  (void)TWI1->TWI_SR;  // Clear stale NACK
+  (void)TWI1->TWI_RHR; // and RXRDY
+  TWI1->TWI_MMR = 0;
+  TWI1->TWI_MMR =
+      TWI_MMR_DADR(MPU_ADDRESS) | TWI_MMR_MREAD | TWI_MMR_IADRSZ_1_BYTE;
+  TWI1->TWI_IADR = TWI_IADR_IADR(reg);
+
+  twi_buffer = buffer;
+  twi_length = length;
+  twi_received = 0;
+  twi_start_us = micros();
+  if (length > 2) {
+    TWI1->TWI_RPR = (uint32_t)buffer;
+    TWI1->TWI_RCR = length - 2;
+    TWI1->TWI_PTCR = TWI_PTCR_RXTEN;
+    TWI1->TWI_CR = TWI_CR_START;
+    twi_phase = TWI_RX_PDC;
+  } else if (length == 2) {
+    TWI1->TWI_CR = TWI_CR_START;
+    twi_phase = TWI_RX_PENULTIMATE;
+  } else {
+    TWI1->TWI_CR = TWI_CR_START | TWI_CR_STOP;
+    twi_phase = TWI_RX_LAST;
+  }
+}
+
+// Starts a single register write
+static void twi_start_write(uint8_t reg, uint8_t value) {
+  TWI1->TWI_PTCR = TWI_PTCR_RXTDIS | TWI_PTCR_TXTDIS;
+  (void)TWI1->TWI_SR;
+  TWI1->TWI_MMR = 0;
+  TWI1->TWI_MMR = TWI_MMR_DADR(MPU_ADDRESS) | TWI_MMR_IADRSZ_1_BYTE;
+  TWI1->TWI_IADR = TWI_IADR_IADR(reg);
+  TWI1->TWI_THR = value;
+  TWI1->TWI_CR = TWI_CR_STOP;
+  twi_start_us = micros();
+  twi_phase = TWI_WAIT_COMPLETE;
+}
+
+// Moves the current transfer on as far as the status flags allow
+static TwiResult twi_step() {
+  while (true) {
+    uint32_t status = TWI1->TWI_SR; // Reading clears NACK
+    if (status & TWI_SR_NACK) {
+      twi_abort();
+      return TWI_FAILED;
+    }
+    switch (twi_phase) {
+    case TWI_RX_PDC:
+      if (!(status & TWI_SR_ENDRX))
+        return TWI_BUSY;
+      TWI1->TWI_PTCR = TWI_PTCR_RXTDIS;
+      twi_received = twi_length - 2;
+      twi_phase = TWI_RX_PENULTIMATE;
+      break;
+    case TWI_RX_PENULTIMATE:
+      if (!(status & TWI_SR_RXRDY))
+        return TWI_BUSY;
+      TWI1->TWI_CR = TWI_CR_STOP;
+      twi_buffer[twi_received++] = TWI1->TWI_RHR;
+      twi_phase = TWI_RX_LAST;
+      break;
+    case TWI_RX_LAST:
+      if (!(status & TWI_SR_RXRDY))
+        return TWI_BUSY;
+      twi_buffer[twi_received++] = TWI1->TWI_RHR;
+      twi_phase = TWI_WAIT_COMPLETE;
+      break;
+    case TWI_WAIT_COMPLETE:
+      if (!(status & TWI_SR_TXCOMP))
+        return TWI_BUSY;
+      twi_phase = TWI_IDLE;
+      return TWI_DONE;
+    default:
+      return TWI_DONE;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// SAM3X: FIFO Read Sequence
+//------------------------------------------------------------------------------
+enum MpuStep { MPU_IDLE, MPU_READ_COUNT, MPU_READ_FIFO, MPU_RESET_FIFO };
+
+static MpuStep mpu_step = MPU_IDLE;
+static uint8_t count_buffer[2];
+static uint8_t fifo_buffer[MPU_SAMPLER_MAX_BURST * MPU_FIFO_SAMPLE_BYTES];
+static uint8_t burst_samples;
+static uint32_t burst_time_us;  // Data-ready time of the newest burst entry
+static bool fifo_backlog = false; // More entries left after the last burst
+static uint32_t last_start_us = 0;
+
+static volatile bool data_ready = false;
+static volatile uint32_t data_ready_us = 0;
+
+// MPU INT: one pulse per sample written to the FIFO
+static void data_ready_isr() {
+  data_ready_us = micros();
+  data_ready = true;
+}
+
+static void attach_data_ready() {
+  pinMode(MPU_INT_PIN, INPUT);
+  attachInterrupt(MPU_INT_PIN, data_ready_isr, RISING);
+}
+
+static int32_t raw_to_mm_s2(int32_t raw) {
+  return raw * MPU_STANDARD_GRAVITY_MM_S2 / MPU_SAMPLER_LSB_PER_G;
+}
+
+static void publish_burst() {
+  int32_t sums[3] = {0, 0, 0};
+  for (uint8_t s = 0; s < burst_samples; s++) {
+    const uint8_t *bytes = &fifo_buffer[s * MPU_FIFO_SAMPLE_BYTES];
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      sums[axis] += (int16_t)((bytes[2 * axis] << 8) | bytes[2 * axis + 1]);
+    }
+  }
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    published.accel_mm_s2[axis] = raw_to_mm_s2(sums[axis] / burst_samples);
+  }
+  published.averaged = burst_samples;
+  published.timestamp_us = burst_time_us;
+  published.sequence++;
+}
+
+// Called when the current transfer has finished; starts the next one if the
+// sequence continues
+static void transfer_done() {
+  switch (mpu_step) {
+  case MPU_READ_COUNT: {
+    uint16_t count = (uint16_t)((count_buffer[0] << 8) | count_buffer[1]);
+    if (count > MPU_FIFO_SIZE - MPU_FIFO_SAMPLE_BYTES) {
+      // Overflowed: the oldest entries were overwritten mid-sample, so the
+      // byte stream is no longer aligned. Start over.
+      error_count++;
+      twi_start_write(MPU_REG_USER_CTRL,
+                      MPU_USER_CTRL_FIFO_EN | MPU_USER_CTRL_FIFO_RESET);
+      mpu_step = MPU_RESET_FIFO;
+      return;
+    }
+    uint16_t available = count / MPU_FIFO_SAMPLE_BYTES;
+    if (available == 0) {
+      mpu_step = MPU_IDLE;
+      return;
+    }
+    burst_samples = available < MPU_SAMPLER_MAX_BURST ? available
+                                                      : MPU_SAMPLER_MAX_BURST;
+    fifo_backlog = available > burst_samples;
+    // The FIFO is read oldest first: with a backlog, the newest entry of this
+    // burst is one sample period older per entry left behind
+    burst_time_us -= (uint32_t)(available - burst_samples) *
+                     (1000000UL / MPU_SAMPLER_RATE_HZ);
+    twi_start_read(MPU_REG_FIFO_R_W, fifo_buffer,
+                   burst_samples * MPU_FIFO_SAMPLE_BYTES);
+    mpu_step = MPU_READ_FIFO;
+    return;
+  }
+  case MPU_READ_FIFO:
+    publish_burst();
+    mpu_step = MPU_IDLE;
+    return;
+  default:
+    mpu_step = MPU_IDLE;
+    return;
+  }
+}
+
+void mpu_sampler_poll() {
+  if (!sampler_started)
+    return;
+
+  uint32_t now = micros();
+  if (mpu_step != MPU_IDLE) {
+    if (now - twi_start_us > MPU_SAMPLER_TRANSFER_TIMEOUT_US) {
+      twi_abort();
+      error_count++;
+      mpu_step = MPU_IDLE;
+      return;
+    }
+    TwiResult result = twi_step();
+    if (result == TWI_BUSY)
+      return;
+    if (result == TWI_FAILED) {
+      error_count++;
+      mpu_step = MPU_IDLE;
+      return;
+    }
+    transfer_done();
+    return;
+  }
+
+  // Idle: read the FIFO on data ready, on a backlog, or as a fallback
+  if (!data_ready && !fifo_backlog &&
+      now - last_start_us < MPU_SAMPLER_FALLBACK_US)
+    return;
+  burst_time_us = data_ready ? data_ready_us : now;
+  data_ready = false;
+  fifo_backlog = false;
+  last_start_us = now;
+  twi_start_read(MPU_REG_FIFO_COUNTH, count_buffer, 2);
+  mpu_step = MPU_READ_COUNT;
+}
+
+#else // Host build
+//------------------------------------------------------------------------------
+// Host: Scripted Acceleration at the Sample Rate
+//------------------------------------------------------------------------------
+static uint32_t next_sample_us = 0;
+
+static void attach_data_ready() {} // Samples are timed by the virtual clock
+
+void mpu_sampler_poll() {
+  if (!sampler_started)
+    return;
+  uint32_t now = micros();
+  if ((int32_t)(now - next_sample_us) < 0)
+    return;
+  next_sample_us = now + 1000000UL / MPU_SAMPLER_RATE_HZ;
+
+  sensors_event_t a, g, temp;
+  mpu.getEvent(&a, &g, &temp);
+  published.accel_mm_s2[0] = (int32_t)(a.acceleration.x * 1000.0f);
+  published.accel_mm_s2[1] = (int32_t)(a.acceleration.y * 1000.0f);
+  published.accel_mm_s2[2] = (int32_t)(a.acceleration.z * 1000.0f);
+  published.averaged = 1;
+  published.timestamp_us = now;
+  published.sequence++;
+}
+#endif
+
+//------------------------------------------------------------------------------
+// Setup and Sample Access
+//------------------------------------------------------------------------------
+bool mpu_sampler_begin() {
+  if (!mpu.begin()) {
+    Serial.println("Failed to find MPU6050 sensor!");
+    return false;
+  }
+  mpu.setAccelerometerRange(MPU6050_RANGE_4_G); // MPU_SAMPLER_LSB_PER_G
+  mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);   // DLPF on: 1 kHz base rate
+  Wire.setClock(400000);
+
+  bool ok = write_register(MPU_REG_SMPLRT_DIV, MPU_SAMPLER_RATE_DIV) &&
+            write_register(MPU_REG_INT_PIN_CFG, 0x00) && // High, 50 us pulse
+            write_register(MPU_REG_FIFO_EN, MPU_FIFO_EN_ACCEL) &&
+            write_register(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_RESET) &&
+            write_register(MPU_REG_USER_CTRL, MPU_USER_CTRL_FIFO_EN) &&
+            write_register(MPU_REG_INT_ENABLE, MPU_INT_DATA_RDY);
+  if (!ok) {
+    Serial.println("MPU6050: FIFO configuration failed!");
+    return false;
+  }
+
+  memset(&published, 0, sizeof(published));
+  attach_data_ready(); // Wire is done with the bus from here on
+  sampler_started = true;
+  if (DEBUG_MODE) {
+    Serial.println("MPU6050 sensor initialized (FIFO, non-blocking reads).");
+  }
+  return true;
+}
+
+bool mpu_sampler_read(MpuSample &sample) {
+  sample = published;
+  return sampler_started && sample.sequence != 0 &&
+         micros() - sample.timestamp_us <= MPU_SAMPLER_MAX_AGE_US;
+}
+
+uint32_t mpu_sampler_get_error_count() { return error_count; }
@@ -0,0 +1,130 @@
+/**
+ * @file profiler.cpp
+ * @brief Implements the per-stage execution time profiler (see profiler.h).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "profiler.h"
+#include "header.h"
+#include <string.h> // For memset
+
+typedef struct {
+  const char *name;
+  uint32_t budget_us; // Longer passes count as overruns
+} ProfileStageInfo;
+
+// Same order as ProfileStage. Budgets follow the task table in main.cpp: the
+// control stages share the 500 us control deadline, background tasks should
+// stay well inside one control period so they never delay it.
+static const ProfileStageInfo stage_info[PROFILE_STAGE_COUNT] = {
+    {"loop_period", 1000},     {"can_rx", 100},
+    {"motor_control", 200},    {"can_tx", 50},
+    {"brake_light", 100},      {"mpu_read", 20},
+    {"decel_estimator", 30},   {"error_monitor", 50},
+    {"bms_supervision", 50},   {"bamocar_requests", 100},
+    {"dashboard", 500},        {"can_diagnostics", 100},
+    {"debug_status", 100000},
+};
+
+static ProfileStageStats stage_stats[PROFILE_STAGE_COUNT];
+
+static inline uint8_t histogram_bucket(uint32_t ticks) {
+  uint32_t scaled = ticks >> PROFILE_HISTOGRAM_MIN_SHIFT;
+  if (scaled == 0)
+    return 0;
+  uint32_t bucket = 32 - __builtin_clz(scaled); // CLZ: one instruction
+  return bucket < PROFILE_HISTOGRAM_BUCKETS ? bucket
+                                            : PROFILE_HISTOGRAM_BUCKETS - 1;
+}
+
+//------------------------------------------------------------------------------
+// Recording
+//------------------------------------------------------------------------------
+void profiler_record(ProfileStage stage, uint32_t ticks) {
+  ProfileStageStats &s = stage_stats[stage];
+  s.count++;
+  s.last_ticks = ticks;
+  if (ticks > s.max_ticks)
+    s.max_ticks = ticks;
+  if (ticks > stage_info[stage].budget_us * CYCLE_COUNTER_TICKS_PER_US)
+    s.overruns++;
+  s.histogram[histogram_bucket(ticks)]++;
+}
+
+void profiler_mark(ProfileStage stage) {
+  uint32_t now = cycle_counter_read();
+  ProfileStageStats &s = stage_stats[stage];
+  uint32_t previous = s.last_mark;
+  s.last_mark = now;
+  if (previous != 0)
+    profiler_record(stage, now - previous);
+}
+
+const ProfileStageStats &profiler_get_stats(ProfileStage stage) {
+  return stage_stats[stage];
+}
+
+void profiler_reset() {
+  CriticalSection lock; // Stages may be recorded from the torque interrupt
+  for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    uint32_t last_mark = stage_stats[i].last_mark;
+    memset(&stage_stats[i], 0, sizeof(stage_stats[i]));
+    stage_stats[i].last_mark = last_mark;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Output
+//------------------------------------------------------------------------------
+void profiler_print() {
+  Serial.println("Profiler: stage, count, last_us, max_us, budget_us, "
+                 "overruns | below_" CYCLE_COUNTER_UNIT ":count ...");
+  for (uint8_t i = 0; i < PROFILE_STAGE_COUNT; i++) {
+    ProfileStageStats s;
+    {
+      CriticalSection lock;
+      s = stage_stats[i];
+    }
+    if (s.count == 0)
+      continue;
+    Serial.print("  ");
+    Serial.print(stage_info[i].name);
+    Serial.print(", ");
+    Serial.print(s.count);
+    Serial.print(", ");
+    Serial.print(s.last_ticks / CYCLE_COUNTER_TICKS_PER_US);
+    Serial.print(", ");
+    Serial.print(s.max_ticks / CYCLE_COUNTER_TICKS_PER_US);
+    Serial.print(", ");
+    Serial.print(stage_info[i].budget_us);
+    Serial.print(", ");
+    Serial.print(s.overruns);
+    Serial.print(" |");
+    for (uint8_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+      if (s.histogram[b] == 0)
+        continue;
+      Serial.print(" ");
+      if (b == PROFILE_HISTOGRAM_BUCKETS - 1) {
+        Serial.print("inf");
+      } else {
+        Serial.print(1UL << (b + PROFILE_HISTOGRAM_MIN_SHIFT)); // Upper edge
+      }
+      Serial.print(":");
+      Serial.print(s.histogram[b]);
+    }
+    Serial.println();
+  }
+}
+
+bool profiler_console_command(int c) {
+  if (c == 'p') {
+    profiler_print();
+  } else if (c == 'r') {
+    profiler_reset();
+    Serial.println("Profiler: Statistics reset.");
+  } else {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file scheduler.cpp
+ * @brief Implements the static-table cooperative scheduler (see scheduler.h).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "scheduler.h"
+#include "header.h"
+#include <string.h> // For memset
+
+// Define the global instance
+Scheduler scheduler;
+
+// True once now has reached t (wrap-safe for differences below ~35 min)
+static inline bool time_reached(uint32_t now_us, uint32_t t_us) {
+  return (int32_t)(now_us - t_us) >= 0;
+}
+
+//------------------------------------------------------------------------------
+// Constructor / Setup
+//------------------------------------------------------------------------------
+Scheduler::Scheduler() : tasks(nullptr), task_count(0) {
+  memset(stats, 0, sizeof(stats));
+}
+
+bool Scheduler::begin(const SchedulerTask *table, uint8_t count) {
+  if (count > SCHEDULER_MAX_TASKS) {
+    if (DEBUG_MODE)
+      Serial.println(
+          "Scheduler: Too many tasks, increase SCHEDULER_MAX_TASKS.");
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    if (table[i].period_us == 0) {
+      if (DEBUG_MODE) {
+        Serial.print("Scheduler: Task has zero period: ");
+        Serial.println(table[i].name);
+      }
+      return false;
+    }
+  }
+
+  tasks = table;
+  task_count = count;
+  uint32_t now = micros();
+  memset(stats, 0, sizeof(stats));
+  for (uint8_t i = 0; i < count; i++) {
+    stats[i].next_release_us = now + table[i].phase_us;
+    stats[i].enabled = table[i].enabled;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Dispatch
+//------------------------------------------------------------------------------
+void Scheduler::run_pending() {
+  bool ran;
+  do {
+    ran = false;
+    uint32_t now = micros();
+    for (uint8_t i = 0; i < task_count; i++) {
+      if (stats[i].enabled && time_reached(now, stats[i].next_release_us)) {
+        run_task(i, now);
+        ran = true;
+        break; // Re-scan from the top: a higher-priority task may be due now
+      }
+    }
+  } while (ran);
+}
+
+void Scheduler::run_task(uint8_t index, uint32_t now_us) {
+  const SchedulerTask &task = tasks[index];
+  SchedulerTaskStats &s = stats[index];
+  uint32_t release = s.next_release_us;
+
+  uint32_t lateness = now_us - release;
+  if (lateness > s.max_lateness_us)
+    s.max_lateness_us = lateness;
+
+  task.run();
+
+  uint32_t end = micros();
+  uint32_t runtime = end - now_us;
+  if (runtime > s.max_runtime_us)
+    s.max_runtime_us = runtime;
+  s.runs++;
+
+  uint32_t deadline = task.deadline_us ? task.deadline_us : task.period_us;
+  if (end - release > deadline)
+    s.deadline_misses++;
+
+  // Stay on the original grid. If whole periods have already gone by, skip
+  // them (and count them) instead of running the task back to back.
+  s.next_release_us = release + task.period_us;
+  uint32_t behind = end - s.next_release_us;
+  if (time_reached(end, s.next_release_us) && behind >= task.period_us) {
+    uint32_t periods = behind / task.period_us;
+    s.skipped_releases += periods;
+    s.next_release_us += periods * task.period_us;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Control / Statistics
+//------------------------------------------------------------------------------
+void Scheduler::set_enabled(uint8_t index, bool enabled) {
+  if (index >= task_count || stats[index].enabled == enabled)
+    return;
+  if (enabled) {
+    // Resume on the original grid, at the first release not in the past
+    uint32_t now = micros();
+    uint32_t period = tasks[index].period_us;
+    if (time_reached(now, stats[index].next_release_us)) {
+      uint32_t periods = (now - stats[index].next_release_us) / period + 1;
+      stats[index].next_release_us += periods * period;
+    }
+  }
+  stats[index].enabled = enabled;
+}
+
+uint32_t Scheduler::get_total_deadline_misses() const {
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < task_count; i++) {
+    total += stats[i].deadline_misses;
+  }
+  return total;
+}
+
+void Scheduler::reset_stats() {
+  for (uint8_t i = 0; i < task_count; i++) {
+    stats[i].runs = 0;
+    stats[i].deadline_misses = 0;
+    stats[i].skipped_releases = 0;
+    stats[i].max_runtime_us = 0;
+    stats[i].max_lateness_us = 0;
+  }
+}
+
+void Scheduler::print_stats() const {
+  Serial.println("Scheduler: task, period_us, runs, misses, skipped, "
+                 "max_runtime_us, max_lateness_us");
+  for (uint8_t i = 0; i < task_count; i++) {
+    Serial.print("  ");
+    Serial.print(tasks[i].name);
+    Serial.print(stats[i].enabled ? ", " : " (disabled), ");
+    Serial.print(tasks[i].period_us);
+    Serial.print(", ");
+    Serial.print(stats[i].runs);
+    Serial.print(", ");
+    Serial.print(stats[i].deadline_misses);
+    Serial.print(", ");
+    Serial.print(stats[i].skipped_releases);
+    Serial.print(", ");
+    Serial.print(stats[i].max_runtime_us);
+    Serial.print(", ");
+    Serial.println(stats[i].max_lateness_us);
+  }
+}
@@ -0,0 +1,164 @@
+/**
+ * @file torque_isr.cpp
+ * @brief Implements the TC timer driven torque control tick (see
+ * torque_isr.h).
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "torque_isr.h"
+#include "cycle_counter.h"
+#include "header.h"
+
+static volatile bool isr_active = false;
+static volatile TorqueIsrStats isr_stats;
+
+static void clear_stats(uint32_t period_cycles) {
+  CriticalSection lock;
+  isr_stats.period_cycles = period_cycles;
+  isr_stats.runs = 0;
+  isr_stats.last_cycles = 0;
+  isr_stats.max_cycles = 0;
+  isr_stats.max_jitter_cycles = 0;
+  isr_stats.overruns = 0;
+}
+
+#if defined(ARDUINO_ARCH_SAM)
+//------------------------------------------------------------------------------
+// SAM3X: TC1 Channel 0
+//------------------------------------------------------------------------------
+#define TORQUE_TC TC1
+#define TORQUE_TC_CHANNEL 0
+#define TORQUE_TC_ID ID_TC3
+#define TORQUE_TC_IRQ TC3_IRQn
+
+// Core clock cycles per timer count
+#define TORQUE_ISR_CYCLES_PER_COUNT (F_CPU / TORQUE_ISR_TIMER_CLOCK_HZ)
+
+static TorqueTickFunction tick_function = nullptr;
+
+bool torque_isr_begin(TorqueTickFunction tick, uint32_t rate_hz) {
+  if (tick == nullptr || rate_hz < 100 || rate_hz > 10000) {
+    if (DEBUG_MODE) {
+      Serial.print("Torque ISR: Unsupported tick rate: ");
+      Serial.println(rate_hz);
+    }
+    return false;
+  }
+
+  torque_isr_end();
+  cycle_counter_init();
+  tick_function = tick;
+  clear_stats(F_CPU / rate_hz);
+
+  // Up-counting, reset on RC compare: the counter value on entry is the time
+  // since the compare, i.e. the interrupt latency.
+  pmc_set_writeprotect(false);
+  pmc_enable_periph_clk(TORQUE_TC_ID);
+  TC_Configure(TORQUE_TC, TORQUE_TC_CHANNEL,
+               TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC | TC_CMR_TCCLKS_TIMER_CLOCK1);
+  TC_SetRC(TORQUE_TC, TORQUE_TC_CHANNEL, TORQUE_ISR_TIMER_CLOCK_HZ / rate_hz);
+  TORQUE_TC->TC_CHANNEL[TORQUE_TC_CHANNEL].TC_IDR = 0xFFFFFFFF;
+  TORQUE_TC->TC_CHANNEL[TORQUE_TC_CHANNEL].TC_IER = TC_IER_CPCS;
+
+  // Same (lowest) priority as SysTick: micros() stays valid in the tick, and
+  // the tick is far shorter than the 1 ms SysTick period.
+  NVIC_SetPriority(TORQUE_TC_IRQ, TORQUE_ISR_IRQ_PRIORITY);
+  NVIC_ClearPendingIRQ(TORQUE_TC_IRQ);
+  NVIC_EnableIRQ(TORQUE_TC_IRQ);
+  isr_active = true;
+  TC_Start(TORQUE_TC, TORQUE_TC_CHANNEL);
+
+  if (DEBUG_MODE) {
+    Serial.print("Torque ISR: Control tick running from TC1 at ");
+    Serial.print(rate_hz);
+    Serial.println(" Hz.");
+  }
+  return true;
+}
+
+void torque_isr_end() {
+  NVIC_DisableIRQ(TORQUE_TC_IRQ);
+  if (isr_active) {
+    TC_Stop(TORQUE_TC, TORQUE_TC_CHANNEL);
+    TORQUE_TC->TC_CHANNEL[TORQUE_TC_CHANNEL].TC_IDR = 0xFFFFFFFF;
+  }
+  NVIC_ClearPendingIRQ(TORQUE_TC_IRQ);
+  isr_active = false;
+}
+
+void TC3_Handler() {
+  uint32_t start = cycle_counter_read();
+  uint32_t jitter = TORQUE_TC->TC_CHANNEL[TORQUE_TC_CHANNEL].TC_CV *
+                    TORQUE_ISR_CYCLES_PER_COUNT;
+  TORQUE_TC->TC_CHANNEL[TORQUE_TC_CHANNEL].TC_SR; // Reading clears CPCS
+
+  tick_function();
+
+  uint32_t elapsed = cycle_counter_read() - start;
+  isr_stats.runs++;
+  isr_stats.last_cycles = elapsed;
+  if (elapsed > isr_stats.max_cycles)
+    isr_stats.max_cycles = elapsed;
+  if (jitter > isr_stats.max_jitter_cycles)
+    isr_stats.max_jitter_cycles = jitter;
+  // Still running at the next compare: that tick starts late (it shows up
+  // as jitter on the next entry)
+  if (jitter + elapsed > isr_stats.period_cycles)
+    isr_stats.overruns++;
+}
+
+#else // Host build
+//------------------------------------------------------------------------------
+// Host: No Timer
+//------------------------------------------------------------------------------
+// The native HAL has no interrupts; the scheduler's control task keeps
+// running the tick.
+bool torque_isr_begin(TorqueTickFunction tick, uint32_t rate_hz) {
+  (void)tick;
+  (void)rate_hz;
+  return false;
+}
+
+void torque_isr_end() { isr_active = false; }
+#endif
+
+//------------------------------------------------------------------------------
+// Statistics
+//------------------------------------------------------------------------------
+bool torque_isr_active() { return isr_active; }
+
+void torque_isr_get_stats(TorqueIsrStats &stats) {
+  CriticalSection lock;
+  stats.period_cycles = isr_stats.period_cycles;
+  stats.runs = isr_stats.runs;
+  stats.last_cycles = isr_stats.last_cycles;
+  stats.max_cycles = isr_stats.max_cycles;
+  stats.max_jitter_cycles = isr_stats.max_jitter_cycles;
+  stats.overruns = isr_stats.overruns;
+}
+
+void torque_isr_reset_stats() { clear_stats(isr_stats.period_cycles); }
+
+void torque_isr_print_stats() {
+  if (!isr_active) {
+    Serial.println("Torque ISR: Not running (scheduler control task).");
+    return;
+  }
+  TorqueIsrStats stats;
+  torque_isr_get_stats(stats);
+  Serial.print("Torque ISR: runs ");
+  Serial.print(stats.runs);
+  Serial.print(", period_us ");
+  Serial.print(stats.period_cycles / CYCLE_COUNTER_TICKS_PER_US);
+  Serial.print(", last_us ");
+  Serial.print(stats.last_cycles / CYCLE_COUNTER_TICKS_PER_US);
+  Serial.print(", wcet_us ");
+  Serial.print(stats.max_cycles / CYCLE_COUNTER_TICKS_PER_US);
+  Serial.print(" (");
+  Serial.print(stats.max_cycles);
+  Serial.print(" cycles), max_jitter_us ");
+  Serial.print(stats.max_jitter_cycles / CYCLE_COUNTER_TICKS_PER_US);
+  Serial.print(", overruns ");
+  Serial.println(stats.overruns);
+}
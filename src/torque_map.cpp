@@ -0,0 +1,147 @@
+/**
+ * @file torque_map.cpp
+ * @brief Implements the driver torque maps (see torque_map.h). The tables are
+ * starting points worked out from simple curves, to be tuned on the car.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "torque_map.h"
+#include "logger.h" // Binary event log (non-blocking)
+
+typedef struct {
+  const char *name;
+  // [speed][pedal], Q15 fraction of full torque
+  q15_t torque[TORQUE_MAP_SPEED_POINTS][TORQUE_MAP_PEDAL_POINTS];
+} TorqueMap;
+
+//------------------------------------------------------------------------------
+// Profiles
+//------------------------------------------------------------------------------
+// Columns: pedal 0, 12.5, 25, ... 100%. Rows: 0, 1024, ... 8192 RPM.
+// Indexed by TorqueProfile.
+static const TorqueMap torque_maps[TORQUE_PROFILE_COUNT] = {
+    // Endurance: pedal^1.5 x 80%, then constant power above 4096 RPM
+    {"endurance",
+     {
+         {0, 1159, 3277, 6020, 9268, 12953, 17027, 21456, 26214}, // 0
+         {0, 1159, 3277, 6020, 9268, 12953, 17027, 21456, 26214}, // 1024
+         {0, 1159, 3277, 6020, 9268, 12953, 17027, 21456, 26214}, // 2048
+         {0, 1159, 3277, 6020, 9268, 12953, 17027, 21456, 26214}, // 3072
+         {0, 1159, 3277, 6020, 9268, 12953, 17027, 21456, 26214}, // 4096
+         {0, 927, 2621, 4816, 7415, 10362, 13621, 17165, 20972},  // 5120
+         {0, 772, 2185, 4013, 6179, 8635, 11351, 14304, 17476},   // 6144
+         {0, 662, 1872, 3440, 5296, 7402, 9730, 12261, 14980},    // 7168
+         {0, 579, 1638, 3010, 4634, 6476, 8513, 10728, 13107},    // 8192
+     }},
+    // Acceleration: torque = pedal everywhere
+    {"acceleration",
+     {
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 0
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 1024
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 2048
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 3072
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 4096
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 5120
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 6144
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 7168
+         {0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32767}, // 8192
+     }},
+    // Skidpad: pedal^2 x 60%, fine throttle control at low speed
+    {"skidpad",
+     {
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 0
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 1024
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 2048
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 3072
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 4096
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 5120
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 6144
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 7168
+         {0, 307, 1229, 2765, 4915, 7680, 11059, 15053, 19661}, // 8192
+     }},
+};
+
+static_assert(TORQUE_MAP_PEDAL_POINTS ==
+                  (1 << (15 - TORQUE_MAP_PEDAL_SHIFT)) + 1,
+              "Pedal breakpoints must split Q15 into 2^n intervals");
+
+// pending_map is written by the console, active_map by the control task /
+// torque interrupt (torque_map_apply_pending): one aligned word each, so no
+// lock is needed
+static const TorqueMap *volatile active_map =
+    &torque_maps[TORQUE_MAP_DEFAULT_PROFILE];
+static const TorqueMap *volatile pending_map =
+    &torque_maps[TORQUE_MAP_DEFAULT_PROFILE];
+
+//------------------------------------------------------------------------------
+// Lookup
+//------------------------------------------------------------------------------
+// a + (b - a) * fraction, fraction in Q15 (32768 = 1.0)
+static inline int32_t lerp_q15(int32_t a, int32_t b, int32_t fraction) {
+  return a + (((b - a) * fraction) >> 15);
+}
+
+q15_t torque_map_lookup_q15(q15_t pedal_q15, int32_t speed_rpm) {
+  if (pedal_q15 <= 0)
+    return 0;
+  if (speed_rpm < 0)
+    speed_rpm = -speed_rpm; // Same map in reverse
+
+  const TorqueMap *map = active_map;
+
+  uint32_t pedal = (uint32_t)pedal_q15; // Below 32768: interval 0-7
+  uint32_t p = pedal >> TORQUE_MAP_PEDAL_SHIFT;
+  int32_t p_fraction =
+      (int32_t)((pedal << (15 - TORQUE_MAP_PEDAL_SHIFT)) & 0x7FFF);
+
+  uint32_t s;
+  int32_t s_fraction;
+  if (speed_rpm >= TORQUE_MAP_MAX_RPM) {
+    s = TORQUE_MAP_SPEED_POINTS - 2; // Last row exactly
+    s_fraction = 1 << 15;
+  } else {
+    s = (uint32_t)speed_rpm >> TORQUE_MAP_SPEED_SHIFT;
+    s_fraction = (int32_t)(((uint32_t)speed_rpm
+                            << (15 - TORQUE_MAP_SPEED_SHIFT)) &
+                           0x7FFF);
+  }
+
+  const q15_t *row_low = map->torque[s];
+  const q15_t *row_high = map->torque[s + 1];
+  int32_t low = lerp_q15(row_low[p], row_low[p + 1], p_fraction);
+  int32_t high = lerp_q15(row_high[p], row_high[p + 1], p_fraction);
+  return q15_saturate(lerp_q15(low, high, s_fraction));
+}
+
+//------------------------------------------------------------------------------
+// Profile Selection
+//------------------------------------------------------------------------------
+void torque_map_select(TorqueProfile profile) {
+  if ((unsigned)profile >= TORQUE_PROFILE_COUNT)
+    return;
+  pending_map = &torque_maps[profile];
+}
+
+bool torque_map_apply_pending() {
+  const TorqueMap *map = pending_map;
+  if (map == active_map)
+    return false;
+  active_map = map;
+  log_event<LOG_TORQUE_MAP_SELECTED>(torque_map_get_profile());
+  return true;
+}
+
+TorqueProfile torque_map_get_profile() {
+  return (TorqueProfile)(active_map - torque_maps);
+}
+
+TorqueProfile torque_map_get_pending() {
+  return (TorqueProfile)(pending_map - torque_maps);
+}
+
+const char *torque_map_profile_name(TorqueProfile profile) {
+  if ((unsigned)profile >= TORQUE_PROFILE_COUNT)
+    return "?";
+  return torque_maps[profile].name;
+}
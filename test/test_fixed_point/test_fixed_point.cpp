@@ -0,0 +1,179 @@
+/**
+ * @file test_fixed_point.cpp
+ * @brief Host tests for the fixed-point torque path against the
+ * floating-point code it replaced (same sweeps as the bench ACCURACY rows):
+ * APPS within 2 LSB with no plausibility mismatches, REG_TORQUE within 1
+ * count, the regen limit and cached regen envelope never above the float
+ * formula, and torque maps that never fall as the pedal rises (the linear
+ * acceleration map within 1 LSB of the pedal).
+ * Run with `pio test -e native`.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#include "bamocar-due.h"
+#include "can_manager.h"
+#include "header.h"
+#include "native_hal.h"
+#include <unity.h>
+
+#define ADC_RAW_MAX ((1 << ADC_SAMPLER_BITS) - 1) // set_analog() full scale
+
+static int32_t abs_diff(int32_t a, int32_t b) { return a > b ? a - b : b - a; }
+
+// Sets both APPS inputs and reads twice so the median filter has settled
+static void set_apps_raw(int32_t raw_1, int32_t raw_2) {
+  AdcSnapshot adc;
+  native_hal::set_analog(APPS_1_PIN, raw_1);
+  native_hal::set_analog(APPS_2_PIN, raw_2);
+  adc_sampler_read(adc);
+  adc_sampler_read(adc);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+//------------------------------------------------------------------------------
+// Tests
+//------------------------------------------------------------------------------
+void test_apps_q15_matches_float() {
+  uint32_t mismatches = 0;
+  int32_t max_err = 0;
+  native_hal::set_serial_echo(false); // Implausibility prints are expected
+  for (int32_t raw_1 = 0; raw_1 <= ADC_RAW_MAX; raw_1 += 3) {
+    for (int32_t delta = -320; delta <= 320; delta += 8) {
+      int32_t raw_2 = raw_1 + delta;
+      if (raw_2 < 0 || raw_2 > ADC_RAW_MAX)
+        continue;
+      set_apps_raw(raw_1, raw_2);
+      double reference = get_apps_reading();
+      q15_t fixed = get_apps_reading_q15();
+
+      if ((reference < 0.0) != (fixed < 0)) {
+        // Allowed only within 1 LSB of the plausibility threshold
+        set_apps_raw(raw_1, raw_1);
+        double p1 = get_apps_reading();
+        set_apps_raw(raw_2, raw_2);
+        double p2 = get_apps_reading();
+        double deviation_lsb = (p1 > p2 ? p1 - p2 : p2 - p1) * 327.68;
+        if (abs_diff((int32_t)(deviation_lsb + 0.5),
+                     APPS_PLAUSIBILITY_THRESHOLD_Q15) > 1)
+          mismatches++;
+        continue;
+      }
+      if (fixed >= 0) {
+        int32_t expected = (int32_t)(reference * 327.68 + 0.5);
+        if (expected > Q15_ONE)
+          expected = Q15_ONE;
+        int32_t err = abs_diff(fixed, expected);
+        if (err > max_err)
+          max_err = err;
+      }
+    }
+  }
+  native_hal::set_serial_echo(true);
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(2, max_err);
+}
+
+void test_torque_register_matches_float() {
+  CAN_FRAME sent;
+  int32_t max_err = 0;
+  uint32_t cases = 0;
+  while (native_hal::can_pop_sent(sent))
+    ;
+  for (int32_t q = Q15_MIN; q <= Q15_ONE; q += 7) {
+    bamocar.setTorqueQ15((q15_t)q);
+    if (!native_hal::can_pop_sent(sent))
+      continue;
+    int32_t fixed = (int16_t)(sent.data.bytes[1] | (sent.data.bytes[2] << 8));
+    int32_t expected = (int32_t)((float)q / 32768.0f * 32760.0f);
+    int32_t err = abs_diff(fixed, expected);
+    if (err > max_err)
+      max_err = err;
+    cases++;
+  }
+  TEST_ASSERT_TRUE(cases > 0);
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(1, max_err);
+}
+
+void test_regen_limit_never_above_float() {
+  const int32_t max_torque_nm = 80;
+  for (int32_t ccl = 1; ccl <= 200; ccl += 7) {
+    for (int32_t volts = 250; volts <= 600; volts += 50) {
+      for (int32_t rpm = 101; rpm <= 8000; rpm += 97) {
+        int32_t power_w = ccl * volts;
+        float rad_s = (float)rpm * (2.0f * PI / 60.0f);
+        float limit = ((float)power_w / rad_s) / (float)max_torque_nm;
+        int32_t expected =
+            limit >= 1.0f ? Q15_ONE : (int32_t)(limit * 32768.0f + 0.5f);
+        TEST_ASSERT_LESS_OR_EQUAL_INT32(
+            expected, regen_torque_limit_q15(power_w, rpm, max_torque_nm));
+      }
+    }
+  }
+}
+
+// Rounded down to its speed bucket, so it may be low but never high
+void test_regen_envelope_never_above_float() {
+  const int32_t max_torque_nm = 80;
+  for (int32_t ccl = 1; ccl <= 200; ccl += 7) {
+    for (int32_t volts = 250; volts <= 600; volts += 50) {
+      for (int32_t rpm = 101; rpm <= 9000; rpm += 97) {
+        int32_t power_w = ccl * volts;
+        float rad_s = (float)rpm * (2.0f * PI / 60.0f);
+        float limit = ((float)power_w / rad_s) / (float)max_torque_nm;
+        int32_t expected =
+            limit >= 1.0f ? Q15_ONE : (int32_t)(limit * 32768.0f + 0.5f);
+        TEST_ASSERT_LESS_OR_EQUAL_INT32(expected,
+                                        regen_envelope_q15(power_w, rpm));
+      }
+    }
+  }
+}
+
+void test_torque_maps_rise_with_pedal() {
+  int32_t max_err = 0;
+  for (int profile = 0; profile < TORQUE_PROFILE_COUNT; profile++) {
+    torque_map_select((TorqueProfile)profile);
+    TEST_ASSERT_TRUE(torque_map_apply_pending() ||
+                     profile == TORQUE_MAP_DEFAULT_PROFILE);
+    for (int32_t rpm = -1000; rpm <= 9000; rpm += 37) {
+      q15_t last = 0;
+      for (int32_t pedal = 0; pedal <= Q15_ONE; pedal += 13) {
+        q15_t torque = torque_map_lookup_q15((q15_t)pedal, rpm);
+        TEST_ASSERT_LESS_OR_EQUAL_INT32(torque, last);
+        last = torque;
+        if (profile == TORQUE_PROFILE_ACCELERATION) {
+          int32_t err = abs_diff(torque, pedal);
+          if (err > max_err)
+            max_err = err;
+        }
+      }
+    }
+  }
+  torque_map_select(TORQUE_MAP_DEFAULT_PROFILE);
+  torque_map_apply_pending();
+  TEST_ASSERT_LESS_OR_EQUAL_INT32(1, max_err);
+}
+
+//------------------------------------------------------------------------------
+// Runner
+//------------------------------------------------------------------------------
+int main() {
+  // Same setup as the bench: brake released, Bamocar on the loopback bus
+  native_hal::set_analog(BRAKE_PRESSURE_SENSOR_PIN, 400);
+  adc_sampler_begin();
+  motor_control_begin(); // Builds the regen envelope table
+  bamocar.registerCANHandler(can_manager);
+  can_manager.initialize(CAN_BPS_500K);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_apps_q15_matches_float);
+  RUN_TEST(test_torque_register_matches_float);
+  RUN_TEST(test_regen_limit_never_above_float);
+  RUN_TEST(test_regen_envelope_never_above_float);
+  RUN_TEST(test_torque_maps_rise_with_pedal);
+  return UNITY_END();
+}
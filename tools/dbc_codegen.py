@@ -0,0 +1,362 @@
+#!/usr/bin/env python3
+"""Generate include/can_signals.h from the DBC files in dbc/.
+
+Every message becomes a struct of constexpr functions that take the frame's
+data bytes. Each signal is one fixed expression of byte loads, shifts and
+masks worked out here, so the firmware does no table walking and the compiler
+sees constants only. Scaled signals get a *_raw() decoder plus a float one
+applying factor and offset.
+
+Supports what the VCU's DBCs use: standard and extended (bit 31) IDs, Intel
+(@1) and Motorola (@0) byte order, signed and unsigned signals up to 32 bits,
+one multiplexer per message (M / mNN) and CM_ comments.
+
+Examples:
+    python3 tools/dbc_codegen.py            # Regenerate after editing a DBC
+    python3 tools/dbc_codegen.py --check    # Exit 1 if the header is stale
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+DEFAULT_DBC_GLOB = os.path.join(ROOT, "dbc", "*.dbc")
+DEFAULT_OUTPUT = os.path.join(ROOT, "include", "can_signals.h")
+
+COLUMNS = 80
+EXTENDED_FLAG = 0x80000000
+
+# BO_ 1056 Orion_Pack_1: 8 BMS
+MESSAGE_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+# SG_ Name [M|mNN] : start|length@order+/- (factor,offset) [min|max] "unit"
+SIGNAL_RE = re.compile(
+    r"^\s+SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*\"([^\"]*)\""
+)
+# CM_ BO_ 1056 "text"; / CM_ SG_ 1056 Name "text";
+COMMENT_RE = re.compile(
+    r'^CM_\s+(BO_|SG_)\s+(\d+)\s+(?:(\w+)\s+)?"([^"]*)"\s*;')
+
+
+class Signal:
+    def __init__(self, match):
+        (self.name, mux, start, length, order, sign, factor, offset, low, high,
+         self.unit) = match.groups()
+        self.start = int(start)
+        self.length = int(length)
+        self.intel = order == "1"
+        self.signed = sign == "-"
+        self.factor = float(factor)
+        self.offset = float(offset)
+        self.range = (low.strip(), high.strip())
+        self.dbc = "%s|%s@%s%s (%s,%s)" % (start, length, order, sign,
+                                           factor.strip(), offset.strip())
+        self.multiplexer = mux == "M"
+        self.mux_value = int(mux[1:]) if mux and mux != "M" else None
+        self.comment = ""
+        if not 1 <= self.length <= 32:
+            raise ValueError("%s: only 1-32 bit signals" % self.name)
+
+    def bit_locations(self):
+        """(byte, bit) of each value bit, least significant first."""
+        if self.intel:
+            positions = [self.start + k for k in range(self.length)]
+        else:
+            # Motorola: start is the MSB, numbered LSB-first within each byte
+            positions = []
+            position = self.start
+            for _ in range(self.length):
+                positions.append(position)
+                position = position + 15 if position % 8 == 0 else position - 1
+            positions.reverse()
+        return [(p // 8, p % 8) for p in positions]
+
+    def min_dlc(self):
+        return max(byte for byte, _ in self.bit_locations()) + 1
+
+    def raw_type(self):
+        if self.length == 1 and not self.signed:
+            return "bool"
+        for width in (8, 16, 32):
+            if self.length <= width:
+                return "%sint%d_t" % ("" if self.signed else "u", width)
+
+    def scaled(self):
+        return self.factor != 1.0 or self.offset != 0.0
+
+    def raw_terms(self):
+        """OR-ed terms extracting the unsigned raw value."""
+        wide = self.length > 16  # int promotion is only safe up to 16 bits
+        runs = []  # [byte, low bit, bit count, value shift]
+        for k, (byte, bit) in enumerate(self.bit_locations()):
+            last = runs[-1] if runs else None
+            if last and last[0] == byte and last[1] + last[2] == bit:
+                last[2] += 1
+            else:
+                runs.append([byte, bit, 1, k])
+        terms = []
+        for byte, low, count, shift in runs:
+            term = "(uint32_t)d[%d]" % byte if wide else "d[%d]" % byte
+            if low:
+                term = "(%s >> %d)" % (term, low)
+            if low + count < 8:
+                term = "(%s & 0x%X)" % (term, (1 << count) - 1)
+            if shift:
+                term = "(%s << %d)" % (term, shift)
+            terms.append(term)
+        return terms
+
+
+class Message:
+    def __init__(self, match):
+        frame_id, self.name, dlc, self.sender = match.groups()
+        frame_id = int(frame_id)
+        self.extended = bool(frame_id & EXTENDED_FLAG)
+        self.id = frame_id & ~EXTENDED_FLAG
+        self.dlc = int(dlc)
+        self.signals = []
+        self.comment = ""
+
+
+def parse_dbc(path):
+    messages = []
+    by_id = {}
+    current = None
+    with open(path) as f:
+        for line in f:
+            match = MESSAGE_RE.match(line)
+            if match:
+                current = Message(match)
+                messages.append(current)
+                by_id[int(match.group(1))] = current
+                continue
+            match = SIGNAL_RE.match(line)
+            if match and current:
+                current.signals.append(Signal(match))
+                continue
+            if not line.startswith((" ", "\t")):
+                current = None
+            match = COMMENT_RE.match(line)
+            if match:
+                kind, frame_id, signal_name, text = match.groups()
+                message = by_id.get(int(frame_id))
+                if message is None:
+                    continue
+                if kind == "BO_":
+                    message.comment = text
+                else:
+                    for signal in message.signals:
+                        if signal.name == signal_name:
+                            signal.comment = text
+    return messages
+
+
+def snake_case(name):
+    name = re.sub(r"(.)([A-Z][a-z]+)", r"\1_\2", name)
+    return re.sub(r"([a-z0-9])([A-Z])", r"\1_\2", name).lower()
+
+
+def camel_case(name):
+    return "".join(part[:1].upper() + part[1:] for part in name.split("_"))
+
+
+def float_literal(value):
+    text = repr(value)
+    if "e" not in text and "." not in text:
+        text += ".0"
+    return text + "f"
+
+
+def wrap_comment(text, indent):
+    """// lines no wider than COLUMNS."""
+    lines = []
+    line = indent + "//"
+    for word in text.split():
+        if len(line) + 1 + len(word) > COLUMNS and line != indent + "//":
+            lines.append(line)
+            line = indent + "//"
+        line += " " + word
+    lines.append(line)
+    return lines
+
+
+def function(return_type, name, expression):
+    """A constexpr decoder, wrapped the way clang-format would."""
+    head = "  static constexpr %s %s(const uint8_t *d) {" % (return_type, name)
+    one_line = "%s return %s; }" % (head, expression_text(expression))
+    if len(one_line) <= COLUMNS:
+        return [one_line]
+    lines = [head]
+    prefix = "    return "
+    line = prefix
+    terms = expression if isinstance(expression, list) else [expression]
+    for i, term in enumerate(terms):
+        piece = term + (" |" if i < len(terms) - 1 else ";")
+        if line != prefix and len(line) + 1 + len(piece) > COLUMNS:
+            lines.append(line)
+            line = " " * len(prefix) + piece
+        else:
+            line += ("" if line == prefix else " ") + piece
+    lines.append(line)
+    lines.append("  }")
+    return lines
+
+
+def expression_text(expression):
+    if isinstance(expression, list):
+        return " | ".join(expression)
+    return expression
+
+
+def unwrap(term):
+    """term without its outer parentheses (a lone term needs none)."""
+    if term.startswith("(") and term.endswith(")"):
+        depth = 0
+        for i, char in enumerate(term):
+            depth += {"(": 1, ")": -1}.get(char, 0)
+            if depth == 0 and i < len(term) - 1:
+                return term
+        return term[1:-1]
+    return term
+
+
+def emit_signal(message, signal):
+    lines = []
+    name = snake_case(signal.name)
+    upper = name.upper()
+    raw_type = signal.raw_type()
+
+    description = "%s: %s [%s, %s]" % (signal.name, signal.dbc, signal.range[0],
+                                       signal.range[1])
+    if signal.unit:
+        description += " " + signal.unit
+    if signal.mux_value is not None:
+        description += " (%s = 0x%X)" % (
+            next(s.name for s in message.signals if s.multiplexer),
+            signal.mux_value)
+    if signal.comment:
+        description += ". " + signal.comment
+    lines += wrap_comment(description, "  ")
+
+    terms = signal.raw_terms()
+    if signal.signed and signal.length not in (8, 16, 32):
+        expression = "(%s)sign_extend<%d>(%s)" % (raw_type, signal.length,
+                                                 expression_text(terms))
+    elif signal.signed and len(terms) == 1 and terms[0].startswith("d["):
+        expression = "(%s)%s" % (raw_type, terms[0])
+    elif signal.signed or len(terms) > 1 and raw_type != "uint32_t":
+        expression = "(%s)(%s)" % (raw_type, expression_text(terms))
+    elif len(terms) == 1:
+        expression = unwrap(terms[0])
+    else:
+        expression = terms
+    raw_name = name + "_raw" if signal.scaled() else name
+    lines += function(raw_type, raw_name, expression)
+    if signal.scaled():
+        physical = "%s(d) * %s" % (raw_name, float_literal(signal.factor))
+        if signal.offset:
+            physical += " %s %s" % ("-" if signal.offset < 0 else "+",
+                                    float_literal(abs(signal.offset)))
+        lines += function("float", name, physical)
+    lines.append("  static constexpr uint8_t %s_MIN_DLC = %d;" %
+                 (upper, signal.min_dlc()))
+    if signal.mux_value is not None:
+        lines.append("  static constexpr uint8_t %s_MUX = 0x%X;" %
+                     (upper, signal.mux_value))
+    return lines
+
+
+def emit_message(message, source):
+    lines = []
+    lines += wrap_comment("%s (0x%X%s, %d bytes, from %s, %s)%s" % (
+        message.name, message.id, " extended" if message.extended else "",
+        message.dlc, message.sender, source,
+        ". " + message.comment if message.comment else ""), "")
+    lines.append("struct %s {" % camel_case(message.name))
+    lines.append("  static constexpr uint32_t ID = 0x%X;" % message.id)
+    lines.append("  static constexpr bool EXTENDED = %s;" %
+                 ("true" if message.extended else "false"))
+    lines.append("  static constexpr uint8_t DLC = %d;" % message.dlc)
+    for signal in message.signals:
+        lines.append("")
+        lines += emit_signal(message, signal)
+    lines.append("};")
+    return lines
+
+
+HEADER = """\
+/**
+ * @file can_signals.h
+ * @brief CAN signal decoders GENERATED by tools/dbc_codegen.py from the DBC
+ * files in dbc/. Do not edit: change the DBC and run
+ *   python3 tools/dbc_codegen.py
+ * One struct per message, one constexpr function per signal taking the
+ * frame's data bytes. Bit positions are fixed at generation time, so each
+ * decoder is a handful of loads, shifts and masks. Scaled signals have a
+ * *_raw() integer decoder and a float one with factor and offset applied.
+ * @author Shane Whelan (UCD Formula Student)
+ * @date 2025-04-27
+ */
+
+#ifndef CAN_SIGNALS_H
+#define CAN_SIGNALS_H
+
+#include <stdint.h>
+
+namespace can_signals {
+
+// Two's complement value of the low BITS bits of raw
+template <uint8_t BITS> constexpr int32_t sign_extend(uint32_t raw) {
+  return (int32_t)(raw << (32 - BITS)) >> (32 - BITS);
+}
+"""
+
+FOOTER = """
+} // namespace can_signals
+
+#endif // CAN_SIGNALS_H
+"""
+
+
+def generate(paths):
+    body = []
+    for path in paths:
+        source = os.path.relpath(path, ROOT).replace(os.sep, "/")
+        for message in parse_dbc(path):
+            body.append("")
+            body += emit_message(message, source)
+    return HEADER + "\n".join(body) + "\n" + FOOTER
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dbc", nargs="*", help="DBC files (default: dbc/*.dbc)")
+    parser.add_argument("--output", default=DEFAULT_OUTPUT)
+    parser.add_argument("--check", action="store_true",
+                        help="only compare with the existing header")
+    options = parser.parse_args()
+
+    paths = sorted(options.dbc or glob.glob(DEFAULT_DBC_GLOB))
+    if not paths:
+        sys.exit("dbc_codegen: no DBC files found")
+    text = generate(paths)
+
+    if options.check:
+        try:
+            with open(options.output) as f:
+                current = f.read()
+        except IOError:
+            current = None
+        if current != text:
+            sys.exit("dbc_codegen: %s is out of date; run "
+                     "python3 tools/dbc_codegen.py" % options.output)
+        return
+    with open(options.output, "w") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Decode the VCU binary log (see include/logger.h) back into text.
+
+Reads the raw Serial byte stream from a file, stdin or a serial port and
+prints one line per record, passing plain text printed on the same port
+through unchanged. Event formats come from include/log_events.def, so the
+decoder always matches the firmware built from the same tree.
+
+Examples:
+    python3 tools/log_decode.py capture.bin
+    python3 tools/log_decode.py --port /dev/ttyACM0 --baud 115200
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC_BYTE = 0xA5
+HEADER_BYTES = 7  # Sync, id, argc, timestamp
+MAX_ARGS = 4
+
+DEFAULT_DEF = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "include", "log_events.def"
+)
+
+# LOG_EVENT(name, category, level, "format")
+EVENT_RE = re.compile(
+    r'^\s*LOG_EVENT\(\s*(\w+)\s*,\s*\w+\s*,\s*\w+\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)'
+)
+
+
+def load_events(path):
+    """Returns [(name, format), ...] in event ID order."""
+    events = []
+    with open(path) as f:
+        for line in f:
+            match = EVENT_RE.match(line)
+            if match:
+                events.append((match.group(1), match.group(2)))
+    return events
+
+
+def format_record(events, event_id, timestamp_us, args):
+    if event_id >= len(events):
+        return "[%10u] <unknown event %d> %s" % (timestamp_us, event_id, args)
+    name, fmt = events[event_id]
+    try:
+        text = fmt % tuple(args)
+    except (TypeError, ValueError):
+        text = "%s %s" % (name, args)
+    return "[%10u] %s" % (timestamp_us, text)
+
+
+def decode(stream, events, out, chunk_size=256):
+    """Decodes records from a byte stream until EOF."""
+    buffer = bytearray()
+    text = bytearray()
+
+    def flush_text():
+        if text:
+            out.write(text.decode("ascii", errors="replace"))
+            out.flush()
+            text.clear()
+
+    while True:
+        chunk = stream.read(chunk_size)
+        if not chunk:
+            break
+        buffer.extend(chunk)
+
+        while buffer:
+            if buffer[0] != SYNC_BYTE:
+                text.append(buffer.pop(0))
+                if text.endswith(b"\n"):
+                    flush_text()
+                continue
+            if len(buffer) < HEADER_BYTES:
+                break  # Need more bytes
+            argc = buffer[2]
+            size = HEADER_BYTES + 4 * argc + 1
+            if argc > MAX_ARGS:
+                text.append(buffer.pop(0))  # Not a record
+                continue
+            if len(buffer) < size:
+                break
+            checksum = 0
+            for byte in buffer[1 : size - 1]:
+                checksum ^= byte
+            if checksum != buffer[size - 1]:
+                text.append(buffer.pop(0))  # Corrupt or not a record; resync
+                continue
+
+            flush_text()
+            timestamp_us = struct.unpack_from("<I", buffer, 3)[0]
+            args = list(struct.unpack_from("<%di" % argc, buffer, HEADER_BYTES))
+            out.write(format_record(events, buffer[1], timestamp_us, args) + "\n")
+            out.flush()
+            del buffer[:size]
+
+    text.extend(buffer)
+    flush_text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", help="capture file (default: stdin)")
+    parser.add_argument("--port", help="read from a serial port (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--events", default=DEFAULT_DEF, help="log_events.def")
+    options = parser.parse_args()
+
+    events = load_events(options.events)
+    chunk_size = 256
+    if options.port:
+        import serial  # pyserial
+
+        stream = serial.Serial(options.port, options.baud, timeout=None)
+        chunk_size = 1  # Blocking reads: print each record as it arrives
+    elif options.input:
+        stream = open(options.input, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    try:
+        decode(stream, events, sys.stdout, chunk_size)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()